@@ -2,6 +2,9 @@
 
 #include "Log.h"
 
+#include <algorithm>
+#include <numeric>
+
 namespace mwse {
 	Arrays Arrays::singleton;
 
@@ -84,6 +87,117 @@ namespace mwse {
 		return success;
 	}
 
+	ContainedArray_t* Arrays::getArray(std::string const& caller, size_t const id) {
+		if (id > 0 && id <= arrays.size()) {
+			return &arrays[id - 1];
+		}
+
+		mwse::log::getLog() << caller << ": Invalid array id: " << id << std::endl;
+		return nullptr;
+	}
+
+	long Arrays::fill(std::string const& caller, size_t const id, size_t const start, size_t const count, ArrayItem_t const value) {
+		ContainedArray_t* a = getArray(caller, id);
+		if (a == nullptr) {
+			return 0;
+		}
+
+		if (start > maxArraySize || count > maxArraySize - start) {
+			mwse::log::getLog() << caller << ": Array index out of bounds. id: " << id << " index: " << start << " count: " << count << std::endl;
+			return 0;
+		}
+
+		if (start + count > a->size()) {
+			a->resize(start + count);
+		}
+		std::fill_n(a->begin() + start, count, value);
+		return 1;
+	}
+
+	long Arrays::copy(std::string const& caller, size_t const sourceId, size_t const sourceIndex, size_t const destinationId, size_t const destinationIndex, size_t const count) {
+		ContainedArray_t* source = getArray(caller, sourceId);
+		ContainedArray_t* destination = getArray(caller, destinationId);
+		if (source == nullptr || destination == nullptr) {
+			return 0;
+		}
+
+		if (sourceIndex > source->size() || count > source->size() - sourceIndex) {
+			mwse::log::getLog() << caller << ": Array index out of bounds. id: " << sourceId << " index: " << sourceIndex << " count: " << count << std::endl;
+			return 0;
+		}
+
+		if (destinationIndex > maxArraySize || count > maxArraySize - destinationIndex) {
+			mwse::log::getLog() << caller << ": Array index out of bounds. id: " << destinationId << " index: " << destinationIndex << " count: " << count << std::endl;
+			return 0;
+		}
+
+		if (destinationIndex + count > destination->size()) {
+			destination->resize(destinationIndex + count);
+		}
+
+		// The source and destination may be the same array, so allow the ranges to overlap.
+		auto sourceBegin = source->begin() + sourceIndex;
+		auto destinationBegin = destination->begin() + destinationIndex;
+		if (source == destination && destinationIndex > sourceIndex) {
+			std::copy_backward(sourceBegin, sourceBegin + count, destinationBegin + count);
+		}
+		else {
+			std::copy(sourceBegin, sourceBegin + count, destinationBegin);
+		}
+		return long(count);
+	}
+
+	long Arrays::sort(std::string const& caller, size_t const id) {
+		ContainedArray_t* a = getArray(caller, id);
+		if (a == nullptr) {
+			return 0;
+		}
+
+		std::sort(a->begin(), a->end());
+		return 1;
+	}
+
+	long Arrays::find(std::string const& caller, size_t const id, ArrayItem_t const value) {
+		ContainedArray_t* a = getArray(caller, id);
+		if (a == nullptr) {
+			return -1;
+		}
+
+		// Expects the array to be sorted.
+		auto result = std::lower_bound(a->begin(), a->end(), value);
+		if (result == a->end() || *result != value) {
+			return -1;
+		}
+		return long(result - a->begin());
+	}
+
+	long long Arrays::getSum(std::string const& caller, size_t const id) {
+		ContainedArray_t* a = getArray(caller, id);
+		if (a == nullptr) {
+			return 0;
+		}
+
+		return std::accumulate(a->begin(), a->end(), 0LL);
+	}
+
+	ArrayItem_t Arrays::getMin(std::string const& caller, size_t const id) {
+		ContainedArray_t* a = getArray(caller, id);
+		if (a == nullptr || a->empty()) {
+			return 0;
+		}
+
+		return *std::min_element(a->begin(), a->end());
+	}
+
+	ArrayItem_t Arrays::getMax(std::string const& caller, size_t const id) {
+		ContainedArray_t* a = getArray(caller, id);
+		if (a == nullptr || a->empty()) {
+			return 0;
+		}
+
+		return *std::max_element(a->begin(), a->end());
+	}
+
 	Arrays_t& Arrays::get() {
 		return arrays;
 	}
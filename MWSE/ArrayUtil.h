@@ -33,6 +33,8 @@ namespace mwse {
 	public:
 		static Arrays &getInstance() { return singleton; };
 
+		static size_t const maxArraySize = 16777215; // bulk operations won't grow an array past this many values
+
 		size_t create(std::string const& caller);
 
 		ArrayItem_t getValue(std::string const& caller, size_t const id, size_t const index);
@@ -43,6 +45,23 @@ namespace mwse {
 
 		long clear(std::string const& caller, size_t const id);
 
+		// Bulk operations. These validate their arguments once, then operate directly on the storage.
+
+		long fill(std::string const& caller, size_t const id, size_t const start, size_t const count, ArrayItem_t const value);
+
+		long copy(std::string const& caller, size_t const sourceId, size_t const sourceIndex, size_t const destinationId, size_t const destinationIndex, size_t const count);
+
+		long sort(std::string const& caller, size_t const id);
+
+		long find(std::string const& caller, size_t const id, ArrayItem_t const value);
+
+		// Summed in 64 bits, which can't overflow for arrays within the size limit.
+		long long getSum(std::string const& caller, size_t const id);
+
+		ArrayItem_t getMin(std::string const& caller, size_t const id);
+
+		ArrayItem_t getMax(std::string const& caller, size_t const id);
+
 		Arrays_t& get();
 
 		ContainedArray_t& get(size_t index);
@@ -50,6 +69,9 @@ namespace mwse {
 	private:
 		Arrays();
 
+		// Returns the array with the given id, or logs and returns nullptr if it doesn't exist.
+		ContainedArray_t* getArray(std::string const& caller, size_t const id);
+
 		static Arrays singleton;
 
 		static size_t const maxArrayId = 16777215; // max 24 bit int - avoid exceding MW global precision
@@ -0,0 +1,165 @@
+#include "ArrayUtilLua.h"
+
+#include "sol.hpp"
+
+#include "LuaManager.h"
+#include "ArrayUtil.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace mwse {
+	namespace lua {
+		// A lua view into an mwscript array. It holds no values of its own, reading and writing the
+		// array storage directly. Lua indices start at 1, so view[1] is mwscript index 0.
+		struct ArrayView {
+			size_t id;
+
+			ContainedArray_t& getStorage() const {
+				auto& arrays = Arrays::getInstance().get();
+				if (id == 0 || id > arrays.size()) {
+					throw std::exception("Array view refers to an invalid array.");
+				}
+				return arrays[id - 1];
+			}
+
+			sol::optional<ArrayItem_t> index(int index) const {
+				ContainedArray_t& storage = getStorage();
+				if (index < 1 || size_t(index) > storage.size()) {
+					return sol::optional<ArrayItem_t>();
+				}
+				return storage[index - 1];
+			}
+
+			void new_index(int index, ArrayItem_t value) {
+				ContainedArray_t& storage = getStorage();
+				if (index < 1) {
+					throw std::exception("Array view indices must be positive.");
+				}
+				if (size_t(index) > Arrays::maxArraySize) {
+					throw std::exception("Array view index is too large.");
+				}
+				if (size_t(index) > storage.size()) {
+					storage.resize(index);
+				}
+				storage[index - 1] = value;
+			}
+
+			size_t length() const {
+				return getStorage().size();
+			}
+		};
+
+		// Accept either an array id or a view wherever an array is expected.
+		static size_t getArrayId(sol::object array) {
+			if (array.is<ArrayView>()) {
+				return array.as<ArrayView>().id;
+			}
+			else if (array.is<double>()) {
+				// Ids are only range checked against the existing arrays later, so only make sure the conversion is safe.
+				double id = array.as<double>();
+				if (!(id >= 0.0 && id <= double(std::numeric_limits<long>::max()))) {
+					throw std::invalid_argument("Invalid array id.");
+				}
+				return size_t(id);
+			}
+			throw std::exception("Expected an array id or array view.");
+		}
+
+		// Validates an index or count given from lua, before it is converted to an unsigned value.
+		static size_t getArrayIndex(const char* name, double value) {
+			if (!(value >= 0.0 && value <= double(Arrays::maxArraySize))) {
+				throw std::invalid_argument(std::string("Invalid array ") + name + ". Value must be between 0 and " + std::to_string(Arrays::maxArraySize) + ".");
+			}
+			return size_t(value);
+		}
+
+		void bindArrayUtil() {
+			sol::state& state = LuaManager::getInstance().getState();
+
+			// Binding for ArrayView.
+			{
+				// Start our usertype. We must finish this with state.set_usertype.
+				auto usertypeDefinition = state.create_simple_usertype<ArrayView>();
+				usertypeDefinition.set("new", sol::no_constructor);
+
+				// Allow values to be get/set by index, as if it were a lua array.
+				usertypeDefinition.set(sol::meta_function::index, &ArrayView::index);
+				usertypeDefinition.set(sol::meta_function::new_index, &ArrayView::new_index);
+				usertypeDefinition.set(sol::meta_function::length, &ArrayView::length);
+
+				// Finish up our usertype.
+				state.set_usertype("mwseArrayView", usertypeDefinition);
+			}
+
+			//
+			// Provide access to the mwscript array storage, with the same bulk operations given to mwscript.
+			// Index parameters are zero-based, matching mwscript.
+			//
+
+			state["mwse"]["array"] = LuaManager::getInstance().createTable();
+
+			state["mwse"]["array"]["create"] = []() {
+				return Arrays::getInstance().create("mwse.array.create");
+			};
+
+			state["mwse"]["array"]["view"] = [](size_t id) -> sol::optional<ArrayView> {
+				if (id == 0 || id > Arrays::getInstance().get().size()) {
+					return sol::optional<ArrayView>();
+				}
+				return ArrayView{ id };
+			};
+
+			state["mwse"]["array"]["size"] = [](sol::object array) {
+				return Arrays::getInstance().getSize("mwse.array.size", getArrayId(array));
+			};
+
+			state["mwse"]["array"]["fill"] = [](sol::object array, ArrayItem_t value, sol::optional<double> start, sol::optional<double> count) {
+				Arrays& arrays = Arrays::getInstance();
+				size_t id = getArrayId(array);
+				size_t first = getArrayIndex("start", start.value_or(0.0));
+
+				// By default, fill to the end of the array.
+				size_t length = 0;
+				if (count) {
+					length = getArrayIndex("count", count.value());
+				}
+				else {
+					size_t size = arrays.getSize("mwse.array.fill", id);
+					length = first < size ? size - first : 0;
+				}
+
+				return arrays.fill("mwse.array.fill", id, first, length, value) != 0;
+			};
+
+			state["mwse"]["array"]["copy"] = [](sol::object source, double sourceIndex, sol::object destination, double destinationIndex, double count) {
+				return Arrays::getInstance().copy("mwse.array.copy", getArrayId(source), getArrayIndex("sourceIndex", sourceIndex),
+					getArrayId(destination), getArrayIndex("destinationIndex", destinationIndex), getArrayIndex("count", count));
+			};
+
+			state["mwse"]["array"]["sort"] = [](sol::object array) {
+				return Arrays::getInstance().sort("mwse.array.sort", getArrayId(array)) != 0;
+			};
+
+			state["mwse"]["array"]["find"] = [](sol::object array, ArrayItem_t value) -> sol::optional<long> {
+				long index = Arrays::getInstance().find("mwse.array.find", getArrayId(array), value);
+				if (index < 0) {
+					return sol::optional<long>();
+				}
+				return index;
+			};
+
+			state["mwse"]["array"]["sum"] = [](sol::object array) {
+				return Arrays::getInstance().getSum("mwse.array.sum", getArrayId(array));
+			};
+
+			state["mwse"]["array"]["min"] = [](sol::object array) {
+				return Arrays::getInstance().getMin("mwse.array.min", getArrayId(array));
+			};
+
+			state["mwse"]["array"]["max"] = [](sol::object array) {
+				return Arrays::getInstance().getMax("mwse.array.max", getArrayId(array));
+			};
+		}
+	}
+}
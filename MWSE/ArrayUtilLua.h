@@ -0,0 +1,7 @@
+#pragma once
+
+namespace mwse {
+	namespace lua {
+		void bindArrayUtil();
+	}
+}
@@ -22,7 +22,7 @@
 
 using namespace mwse;
 
-static const int table_size = 255;
+static const int table_size = 256;
 
 InstructionStore InstructionStore::single_instance;
 
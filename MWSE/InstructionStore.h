@@ -72,6 +72,14 @@ namespace mwse {
                 return secondary_table[secondary_index];
             }
 
+			// Get the implementation for an opcode, or NULL if we don't own it. This lets the hooks check for
+			// and fetch an instruction with a single lookup.
+			inline InstructionInterface_t *find(const OpCode::OpCode_t opcode)
+			{
+                InstructionInterface_t **secondary_table = opCode_primary_table[(opcode >> 8) & 0xFF];
+                return (secondary_table != NULL) ? secondary_table[opcode & 0xFF] : NULL;
+			}
+
 			//check if a certain opcode exists, inline to make it as fast as possible.
 			inline bool isOpcode(const OpCode::OpCode_t opcode)
 			{
@@ -0,0 +1,133 @@
+#include "InventoryStackIndex.h"
+
+#include "TES3Inventory.h"
+#include "TES3Object.h"
+
+#include <cmath>
+
+namespace mwse {
+	namespace tes3 {
+		InventoryStackIndex InventoryStackIndex::singleton;
+
+		TES3::ItemStack* InventoryStackIndex::findItemStack(TES3::Inventory* inventory, TES3::Object* item) {
+			Entry& entry = getEntry(inventory);
+			auto result = entry.stacks.find(item);
+			if (result == entry.stacks.end()) {
+				return nullptr;
+			}
+
+			// The stack list can look unchanged while a stack was replaced, so make sure the stack still
+			// holds the item. If not, fall back to searching the list, and start the entry over.
+			TES3::ItemStack* stack = result->second;
+			if (stack->object != item || stack->count == 0) {
+				rebuild(entry, inventory);
+				result = entry.stacks.find(item);
+				return result != entry.stacks.end() ? result->second : nullptr;
+			}
+
+			return stack;
+		}
+
+		float InventoryStackIndex::getContainedWeight(TES3::Inventory* inventory) {
+			return getEntry(inventory).weight;
+		}
+
+		int InventoryStackIndex::beginItemChange(TES3::Inventory* inventory, TES3::Object* item) {
+			TES3::ItemStack* stack = findItemStack(inventory, item);
+			return stack ? std::abs(stack->count) : 0;
+		}
+
+		void InventoryStackIndex::endItemChange(TES3::Inventory* inventory, TES3::Object* item, int countBefore) {
+			auto result = m_Entries.find(inventory);
+			if (result == m_Entries.end()) {
+				return;
+			}
+
+			Entry& entry = result->second;
+			int sizeDifference = inventory->iterator.size - entry.size;
+			auto stack = entry.stacks.find(item);
+
+			// The existing stack changed its count.
+			if (sizeDifference == 0 && stack != entry.stacks.end()) {
+				entry.weight += item->getWeight() * (std::abs(stack->second->count) - countBefore);
+			}
+
+			// The stack was removed.
+			else if (sizeDifference == -1 && stack != entry.stacks.end()) {
+				entry.weight -= item->getWeight() * countBefore;
+				entry.stacks.erase(stack);
+			}
+
+			// A new stack was added. The engine puts new stacks at one of the list's ends.
+			else if (sizeDifference == 1 && stack == entry.stacks.end()) {
+				auto head = inventory->iterator.head;
+				auto tail = inventory->iterator.tail;
+				TES3::ItemStack* newStack = nullptr;
+				if (head && head->data->object == item) {
+					newStack = head->data;
+				}
+				else if (tail && tail->data->object == item) {
+					newStack = tail->data;
+				}
+
+				if (newStack == nullptr) {
+					m_Entries.erase(result);
+					return;
+				}
+
+				entry.stacks[item] = newStack;
+				entry.weight += item->getWeight() * std::abs(newStack->count);
+			}
+
+			// Something we don't understand happened.
+			else {
+				m_Entries.erase(result);
+				return;
+			}
+
+			updateSignature(entry, inventory);
+		}
+
+		void InventoryStackIndex::invalidate(TES3::Inventory* inventory) {
+			m_Entries.erase(inventory);
+		}
+
+		void InventoryStackIndex::onFrame() {
+			m_Entries.clear();
+		}
+
+		InventoryStackIndex::Entry& InventoryStackIndex::getEntry(TES3::Inventory* inventory) {
+			auto result = m_Entries.find(inventory);
+			if (result != m_Entries.end() && isCurrent(result->second, inventory)) {
+				return result->second;
+			}
+
+			Entry& entry = m_Entries[inventory];
+			rebuild(entry, inventory);
+			return entry;
+		}
+
+		bool InventoryStackIndex::isCurrent(const Entry& entry, const TES3::Inventory* inventory) const {
+			return entry.size == inventory->iterator.size
+				&& entry.head == inventory->iterator.head
+				&& entry.tail == inventory->iterator.tail;
+		}
+
+		void InventoryStackIndex::rebuild(Entry& entry, TES3::Inventory* inventory) {
+			entry.stacks.clear();
+			entry.weight = 0.0f;
+			for (auto i = inventory->iterator.head; i; i = i->next) {
+				// Keep the first stack found, like the engine's search does.
+				entry.stacks.emplace(i->data->object, i->data);
+				entry.weight += i->data->object->getWeight() * std::abs(i->data->count);
+			}
+			updateSignature(entry, inventory);
+		}
+
+		void InventoryStackIndex::updateSignature(Entry& entry, const TES3::Inventory* inventory) {
+			entry.size = inventory->iterator.size;
+			entry.head = inventory->iterator.head;
+			entry.tail = inventory->iterator.tail;
+		}
+	}
+}
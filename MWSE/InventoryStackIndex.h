@@ -0,0 +1,59 @@
+#pragma once
+
+#include "TES3Defines.h"
+
+#include <unordered_map>
+
+namespace mwse {
+	namespace tes3 {
+		// Side index for inventories, mapping each item to its stack and caching the total weight.
+		// The engine changes inventories without going through our wrappers, so cached data is
+		// dropped every frame, and only trusted while the stack list looks unchanged. Stacks found
+		// through the index are also checked to still hold the item before being returned.
+		class InventoryStackIndex {
+		public:
+			static InventoryStackIndex& getInstance() { return singleton; };
+
+			// Equivalent to the engine's stack search, but usually without walking the stack list.
+			TES3::ItemStack* findItemStack(TES3::Inventory* inventory, TES3::Object* item);
+
+			// The sum of each stack's weight. Kept up to date by our wrappers. Counts the engine changes
+			// in place on its own aren't seen until the entry is next rebuilt, at the latest next frame.
+			float getContainedWeight(TES3::Inventory* inventory);
+
+			// Our wrappers call these around any change to an item's stack. The index is then patched
+			// in place when possible, instead of being rebuilt.
+			int beginItemChange(TES3::Inventory* inventory, TES3::Object* item);
+			void endItemChange(TES3::Inventory* inventory, TES3::Object* item, int countBefore);
+
+			// Drops anything cached for an inventory.
+			void invalidate(TES3::Inventory* inventory);
+
+			// Cached data from previous frames can no longer be trusted.
+			void onFrame();
+
+		private:
+			InventoryStackIndex() = default;
+
+			static InventoryStackIndex singleton;
+
+			struct Entry {
+				// Stack list state when this entry was last known good.
+				int size;
+				void* head;
+				void* tail;
+
+				std::unordered_map<TES3::Object*, TES3::ItemStack*> stacks;
+				float weight;
+			};
+
+			// Gets an up to date entry for the inventory, rebuilding it if needed.
+			Entry& getEntry(TES3::Inventory* inventory);
+			bool isCurrent(const Entry& entry, const TES3::Inventory* inventory) const;
+			void rebuild(Entry& entry, TES3::Inventory* inventory);
+			void updateSignature(Entry& entry, const TES3::Inventory* inventory);
+
+			std::unordered_map<TES3::Inventory*, Entry> m_Entries;
+		};
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+
+namespace mwse {
+	// A bounded multi-producer, single-consumer ring buffer. Producers never block each other, and
+	// the consumer can cheaply check if there is anything to do. Capacity must be a power of two.
+	template <typename T, size_t Capacity>
+	class LockFreeQueue {
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "LockFreeQueue capacity must be a power of two.");
+
+	public:
+		LockFreeQueue() :
+			m_EnqueuePosition(0),
+			m_DequeuePosition(0)
+		{
+			for (size_t i = 0; i < Capacity; i++) {
+				m_Cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		LockFreeQueue(const LockFreeQueue&) = delete;
+		LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+		// Attempts to add a value to the queue. Returns false if the queue is full.
+		bool tryPush(const T& value) {
+			size_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+			while (true) {
+				Cell& cell = m_Cells[position & (Capacity - 1)];
+				size_t sequence = cell.sequence.load(std::memory_order_acquire);
+				intptr_t difference = intptr_t(sequence) - intptr_t(position);
+				if (difference == 0) {
+					// The cell is free. Try to claim it.
+					if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+						cell.value = value;
+						cell.sequence.store(position + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (difference < 0) {
+					// The consumer hasn't freed this cell yet.
+					return false;
+				}
+				else {
+					// Another producer claimed this cell first.
+					position = m_EnqueuePosition.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// Removes the oldest value from the queue. Returns false if the queue is empty. Only one
+		// thread may consume from the queue.
+		bool tryPop(T& out) {
+			size_t position = m_DequeuePosition.load(std::memory_order_relaxed);
+			Cell& cell = m_Cells[position & (Capacity - 1)];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			if (intptr_t(sequence) - intptr_t(position + 1) < 0) {
+				return false;
+			}
+
+			out = cell.value;
+			m_DequeuePosition.store(position + 1, std::memory_order_relaxed);
+			cell.sequence.store(position + Capacity, std::memory_order_release);
+			return true;
+		}
+
+		// Checks for pending values without touching any cells. Only reliable from the consumer thread.
+		bool empty() const {
+			return m_DequeuePosition.load(std::memory_order_relaxed) == m_EnqueuePosition.load(std::memory_order_acquire);
+		}
+
+	private:
+		struct Cell {
+			std::atomic<size_t> sequence;
+			T value;
+		};
+
+		// Producer and consumer positions are kept on separate cache lines to avoid false sharing.
+		alignas(64) std::atomic<size_t> m_EnqueuePosition;
+		alignas(64) std::atomic<size_t> m_DequeuePosition;
+		alignas(64) Cell m_Cells[Capacity];
+	};
+}
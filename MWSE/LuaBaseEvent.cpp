@@ -1,35 +1,564 @@
-
 #include "LuaBaseEvent.h"
 
 #include "LuaManager.h"
+#include "LuaUtil.h"
+
+#include "TES3Actor.h"
+#include "TES3Reference.h"
 
 #include "Log.h"
 
+#include <cstring>
+
 namespace mwse {
 	namespace lua {
 		namespace event {
-			sol::object trigger(const char* eventType, sol::table eventData, sol::object eventOptions) {
-				sol::state& state = LuaManager::getInstance().getState();
+			//
+			// EventFilterKey
+			//
+
+			EventFilterKey::EventFilterKey(sol::object filter) :
+				type(filter.get_type()),
+				number(0.0),
+				pointer(nullptr)
+			{
+				switch (type) {
+				case sol::type::number:
+					number = filter.as<double>();
+					break;
+				case sol::type::boolean:
+					number = filter.as<bool>() ? 1.0 : 0.0;
+					break;
+				case sol::type::string:
+					string = filter.as<std::string>();
+					break;
+				case sol::type::lua_nil:
+				case sol::type::none:
+					type = sol::type::lua_nil;
+					break;
+				default:
+					pointer = filter.pointer();
+					break;
+				}
+			}
+
+			bool EventFilterKey::operator==(const EventFilterKey& other) const {
+				return type == other.type && number == other.number && pointer == other.pointer && string == other.string;
+			}
+
+			size_t EventFilterKeyHasher::operator()(const EventFilterKey& key) const {
+				switch (key.type) {
+				case sol::type::number:
+				case sol::type::boolean:
+					return std::hash<double>()(key.number);
+				case sol::type::string:
+					return std::hash<std::string>()(key.string);
+				}
+				return std::hash<const void*>()(key.pointer);
+			}
+
+			//
+			// Lazy payload state. Reset along with the callback registry.
+			//
+
+			static bool lazyEventPayloads = false;
+
+			// Metatable shared by all lazy event tables.
+			static sol::table lazyEventMetatable;
+
+			// Fields not yet read, kept outside of the event table so that lua never sees the native
+			// pointers. Events nest, so the fields for the innermost event are at the back.
+			struct PendingLazyField {
+				const void* eventData;
+				const LazyEventField* field;
+				void* data;
+			};
+			static std::vector<PendingLazyField> pendingLazyFields;
+
+			// Called once an event is done dispatching. The native pointers may not outlive the event,
+			// so any fields that weren't read by then stay nil.
+			static void releaseLazyEventFields(const sol::table& eventData) {
+				const void* pointer = eventData.pointer();
+				while (!pendingLazyFields.empty() && pendingLazyFields.back().eventData == pointer) {
+					pendingLazyFields.pop_back();
+				}
+			}
+
+			//
+			// EventCallbacks
+			//
+
+			bool EventCallbacks::hasListeners() const {
+				return (general && !general->empty()) || !filtered.empty();
+			}
+
+			EventCallbackListPointer EventCallbacks::getFilteredCallbacks(sol::object filter) const {
+				if (filtered.empty()) {
+					return nullptr;
+				}
+
+				auto result = filtered.find(EventFilterKey(filter));
+				if (result == filtered.end()) {
+					return nullptr;
+				}
+
+				return result->second.callbacks;
+			}
+
+			//
+			// Callback registry.
+			//
+
+			// Registered callbacks, by event type.
+			static std::unordered_map<std::string, EventCallbacks> eventCallbacks;
+
+			// Fast lookup for events raised from native code. Their names are always string literals,
+			// so the address is enough to identify them without hashing the string.
+			static std::unordered_map<const char*, EventCallbacks*> nativeEventCallbacks;
+
+			EventCallbacks& getEventCallbacks(const char* eventType) {
+				return eventCallbacks[eventType];
+			}
+
+			static EventCallbacks& getNativeEventCallbacks(const char* eventType) {
+				auto result = nativeEventCallbacks.find(eventType);
+				if (result != nativeEventCallbacks.end()) {
+					return *result->second;
+				}
+
+				EventCallbacks* callbacks = &getEventCallbacks(eventType);
+				nativeEventCallbacks[eventType] = callbacks;
+				return *callbacks;
+			}
+
+			bool hasListeners(const char* eventType) {
+				return getNativeEventCallbacks(eventType).hasListeners();
+			}
+
+			// Returns a copy of the list with the given callback added in priority order, or nullptr if
+			// the callback was already present.
+			static EventCallbackListPointer addToCallbackList(const EventCallbackListPointer& list, const EventCallback& callback) {
+				auto newList = list ? std::make_shared<EventCallbackList>(*list) : std::make_shared<EventCallbackList>();
+
+				auto insertPosition = newList->end();
+				for (auto itt = newList->begin(); itt != newList->end(); itt++) {
+					if (itt->callback == callback.callback) {
+						return nullptr;
+					}
+					else if (insertPosition == newList->end() && itt->priority < callback.priority) {
+						insertPosition = itt;
+					}
+				}
+
+				newList->insert(insertPosition, callback);
+				return newList;
+			}
+
+			// Returns a copy of the list with the given callback removed, or nullptr if it wasn't found.
+			static EventCallbackListPointer removeFromCallbackList(const EventCallbackListPointer& list, const sol::protected_function& callback) {
+				if (!list) {
+					return nullptr;
+				}
 
-				// Trigger the function, check for lua errors.
-				sol::protected_function trigger = state["event"]["trigger"];
-				sol::protected_function_result result = trigger(eventType, eventData, eventOptions);
-				if (result.valid()) {
-					return result;
+				for (auto itt = list->begin(); itt != list->end(); itt++) {
+					if (itt->callback == callback) {
+						auto newList = std::make_shared<EventCallbackList>(*list);
+						newList->erase(newList->begin() + (itt - list->begin()));
+						return newList;
+					}
+				}
+
+				return nullptr;
+			}
+
+			bool registerCallback(const char* eventType, sol::protected_function callback, sol::object filter, double priority, bool doOnce) {
+				EventCallback eventCallback = { callback, priority, doOnce, profiler::getCallbackStatistics(eventType, callback) };
+
+				// Report errors with a full traceback, as the old lua-side dispatcher did.
+				eventCallback.callback.error_handler = LuaManager::getInstance().getState()["debug"]["traceback"];
+
+				EventCallbacks& callbacks = getEventCallbacks(eventType);
+				if (filter == sol::nil) {
+					auto newList = addToCallbackList(callbacks.general, eventCallback);
+					if (newList == nullptr) {
+						return false;
+					}
+					callbacks.general = newList;
 				}
 				else {
-					sol::error error = result;
-					log::getLog() << "Event system error encountered when raising " << eventType << " event:" << std::endl << error.what() << std::endl;
+					EventFilterKey key(filter);
+					auto& filtered = callbacks.filtered[key];
+					auto newList = addToCallbackList(filtered.callbacks, eventCallback);
+					if (newList == nullptr) {
+						return false;
+					}
+					filtered.filter = filter;
+					filtered.callbacks = newList;
 				}
 
-				return sol::nil;
+				return true;
+			}
+
+			bool unregisterCallback(const char* eventType, sol::protected_function callback, sol::object filter) {
+				EventCallbacks& callbacks = getEventCallbacks(eventType);
+				if (filter == sol::nil) {
+					auto newList = removeFromCallbackList(callbacks.general, callback);
+					if (newList == nullptr) {
+						return false;
+					}
+					callbacks.general = newList;
+				}
+				else {
+					auto filtered = callbacks.filtered.find(EventFilterKey(filter));
+					if (filtered == callbacks.filtered.end()) {
+						return false;
+					}
+
+					auto newList = removeFromCallbackList(filtered->second.callbacks, callback);
+					if (newList == nullptr) {
+						return false;
+					}
+
+					// Drop empty filters so that the listener check stays accurate.
+					if (newList->empty()) {
+						callbacks.filtered.erase(filtered);
+					}
+					else {
+						filtered->second.callbacks = newList;
+					}
+				}
+
+				return true;
+			}
+
+			void clear(const char* eventType, sol::object filter) {
+				if (filter == sol::nil) {
+					// Clear out general events of this type.
+					if (eventType != nullptr) {
+						getEventCallbacks(eventType).general = nullptr;
+					}
+				}
+				else if (eventType == nullptr) {
+					// No event supplied, so let's clear out all events for this filter.
+					clearObjectFilter(filter);
+				}
+				else {
+					// Clear out a specific event type/filter combo.
+					getEventCallbacks(eventType).filtered.erase(EventFilterKey(filter));
+				}
 			}
 
 			void clearObjectFilter(sol::object filterObject) {
+				EventFilterKey key(filterObject);
+				for (auto& callbacks : eventCallbacks) {
+					if (!callbacks.second.filtered.empty()) {
+						callbacks.second.filtered.erase(key);
+					}
+				}
+			}
+
+			void clearAll() {
+				// Entries are kept alive, as references to them may be cached.
+				for (auto& callbacks : eventCallbacks) {
+					callbacks.second.general = nullptr;
+					callbacks.second.filtered.clear();
+				}
+
+				lazyEventMetatable = sol::nil;
+				pendingLazyFields.clear();
+			}
+
+			//
+			// Event dispatching.
+			//
+
+			static bool isTruthy(const sol::object& object) {
+				if (object.get_type() == sol::type::boolean) {
+					return object.as<bool>();
+				}
+				return object.valid();
+			}
+
+			// Calls each callback in the list. Returns true if the event was claimed.
+			static bool triggerCallbacks(const char* eventType, EventCallbackListPointer callbacks, sol::table& eventData, sol::object filter) {
+				if (!callbacks) {
+					return false;
+				}
+
+				for (const auto& eventCallback : *callbacks) {
+					bool profiling = profiler::getEnabled() && eventCallback.statistics;
+					profiler::Clock::time_point start;
+					if (profiling) {
+						start = profiler::Clock::now();
+					}
+
+					sol::protected_function_result result = eventCallback.callback(eventData);
+
+					if (profiling) {
+						eventCallback.statistics->addSample(profiler::getMilliseconds(start, profiler::Clock::now()));
+					}
+
+					if (!result.valid()) {
+						sol::error error = result;
+						log::getLog() << "Error in event callback: " << error.what() << std::endl;
+					}
+					else if (result.return_count() > 0 && result.get<sol::object>() != sol::nil) {
+						// Returning non-nil from the callback claims/blocks the event.
+						eventData["claim"] = true;
+						eventData["block"] = true;
+					}
+
+					if (eventCallback.doOnce) {
+						unregisterCallback(eventType, eventCallback.callback, filter);
+					}
+
+					// If the event is claimed, do not excute any further events.
+					if (isTruthy(eventData["claim"])) {
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			static sol::object dispatch(const char* eventType, const EventCallbacks& callbacks, sol::table eventData, sol::object filter) {
+				if (eventData == sol::nil) {
+					eventData = LuaManager::getInstance().createTable();
+				}
+
+				eventData["eventType"] = eventType;
+				eventData["eventFilter"] = filter;
+
+				// Filtered callbacks get the first chance to handle the event.
+				if (filter != sol::nil) {
+					if (triggerCallbacks(eventType, callbacks.getFilteredCallbacks(filter), eventData, filter)) {
+						return eventData;
+					}
+
+					// At this point we've run through the filtered events. Fire off the unfiltered events too.
+					eventData["eventFilter"] = sol::nil;
+				}
+
+				triggerCallbacks(eventType, callbacks.general, eventData, sol::nil);
+
+				return eventData;
+			}
+
+			static sol::object trigger(const char* eventType, const EventCallbacks& callbacks, sol::table eventData, sol::object filter) {
+				if (!profiler::getEnabled()) {
+					return dispatch(eventType, callbacks, eventData, filter);
+				}
+
+				if (callbacks.statistics == nullptr) {
+					callbacks.statistics = profiler::getEventStatistics(eventType);
+				}
+
+				auto start = profiler::Clock::now();
+				sol::object result = dispatch(eventType, callbacks, eventData, filter);
+				callbacks.statistics->addSample(profiler::getMilliseconds(start, profiler::Clock::now()));
+				return result;
+			}
+
+			static sol::object getFilterFromOptions(sol::object options) {
+				if (options.get_type() == sol::type::table) {
+					return options.as<sol::table>()["filter"];
+				}
+				return sol::nil;
+			}
+
+			sol::object trigger(BaseEvent* baseEvent) {
+				const char* eventType = baseEvent->getEventName();
+				const EventCallbacks& callbacks = getNativeEventCallbacks(eventType);
+
+				// Nothing is listening. Don't bother creating the event table.
+				if (!callbacks.hasListeners()) {
+					return sol::nil;
+				}
+
+				// If only filtered callbacks exist, make sure one applies before creating the event table.
+				sol::object filter = sol::nil;
+				if (!callbacks.filtered.empty()) {
+					filter = getFilterFromOptions(baseEvent->getEventOptions());
+				}
+				if (!callbacks.general || callbacks.general->empty()) {
+					auto filteredCallbacks = callbacks.getFilteredCallbacks(filter);
+					if (!filteredCallbacks || filteredCallbacks->empty()) {
+						return sol::nil;
+					}
+				}
+
+				sol::table eventData = baseEvent->createEventTable();
+				sol::object result = trigger(eventType, callbacks, eventData, filter);
+				releaseLazyEventFields(eventData);
+				return result;
+			}
+
+			sol::object trigger(const char* eventType, sol::table eventData, sol::object eventOptions) {
+				return trigger(eventType, getEventCallbacks(eventType), eventData, getFilterFromOptions(eventOptions));
+			}
+
+			//
+			// Lazily materialized payloads.
+			//
+
+			LazyEventField::LazyEventField(const char* name, Resolver resolver) :
+				name(name),
+				resolver(resolver)
+			{
+
+			}
+
+			const LazyEventField lazyMobileField("mobile", [](void* data) {
+				return makeLuaObject(static_cast<TES3::MobileObject*>(data));
+			});
+
+			const LazyEventField lazyReferenceField("reference", [](void* data) {
+				return makeLuaObject(static_cast<TES3::BaseObject*>(data));
+			});
+
+			bool getLazyEventPayloads() {
+				return lazyEventPayloads;
+			}
+
+			void setLazyEventPayloads(bool enabled) {
+				lazyEventPayloads = enabled;
+			}
+
+			// Once read, the resolved value is stored under the field's name so later reads don't come back here.
+			static sol::object lazyEventTableIndex(sol::table self, sol::object key) {
+				if (key.get_type() != sol::type::string || pendingLazyFields.empty()) {
+					return sol::nil;
+				}
+
+				const void* pointer = self.pointer();
+				const char* name = key.as<const char*>();
+				for (auto itt = pendingLazyFields.rbegin(); itt != pendingLazyFields.rend(); itt++) {
+					if (itt->eventData == pointer && itt->data != nullptr && strcmp(itt->field->name, name) == 0) {
+						sol::object value = itt->field->resolver(itt->data);
+						itt->data = nullptr;
+						self.raw_set(itt->field->name, value);
+						return value;
+					}
+				}
+
+				return sol::nil;
+			}
+
+			sol::table createLazyEventTable(int expectedFields) {
 				sol::state& state = LuaManager::getInstance().getState();
-				sol::protected_function trigger = state["event"]["clear"];
-				trigger(sol::nil, filterObject);
+				sol::table eventData = state.create_table(0, expectedFields);
+
+				if (lazyEventPayloads) {
+					if (lazyEventMetatable == sol::nil) {
+						lazyEventMetatable = state.create_table();
+						lazyEventMetatable[sol::meta_function::index] = &lazyEventTableIndex;
+					}
+					eventData[sol::metatable_key] = lazyEventMetatable;
+				}
+
+				return eventData;
+			}
+
+			void setLazyEventField(sol::table& eventData, const LazyEventField& field, void* data) {
+				if (data == nullptr) {
+					return;
+				}
+
+				if (lazyEventPayloads) {
+					pendingLazyFields.push_back({ eventData.pointer(), &field, data });
+				}
+				else {
+					eventData[field.name] = field.resolver(data);
+				}
 			}
+
+			//
+			// Lua binding helpers.
+			//
+
+			// Resolve the filter to use from the options table. We always filter on the base-most object.
+			static sol::object getRegistrationFilter(sol::optional<sol::table> options) {
+				if (!options) {
+					return sol::nil;
+				}
+
+				sol::object filter = options.value()["filter"];
+				if (filter.get_type() != sol::type::userdata) {
+					return filter;
+				}
+
+				// References get converted to the base object.
+				if (filter.is<TES3::Reference*>()) {
+					logStackTrace("Warning: Event registered to reference. Reference-type filtering was deprecated on 2018-12-15, and will be removed in future versions. Please update accordingly.");
+					filter = makeLuaObject(filter.as<TES3::Reference*>()->baseObject);
+				}
+
+				// Actors and containers get converted to their base object.
+				if (filter.is<TES3::BaseObject*>()) {
+					TES3::BaseObject* object = filter.as<TES3::BaseObject*>();
+					if (object->objectType == TES3::ObjectType::Container || object->objectType == TES3::ObjectType::Creature || object->objectType == TES3::ObjectType::NPC) {
+						auto asActor = static_cast<TES3::Actor*>(object);
+						if (!asActor->getActorFlag(TES3::ActorFlag::IsBase)) {
+							logStackTrace("Warning: Event registered to actor clone. Switched to base object.");
+							filter = makeLuaObject(asActor->getBaseActor());
+						}
+					}
+				}
+
+				return filter;
+			}
+
+			static void validateEventArguments(const char* functionName, sol::object eventType, sol::object callback) {
+				if (eventType.get_type() != sol::type::string || eventType.as<std::string>().empty()) {
+					throw std::exception((std::string(functionName) + ": Event type must be a valid string.").c_str());
+				}
+
+				if (callback.get_type() != sol::type::function) {
+					throw std::exception((std::string(functionName) + ": Event callback must be a function.").c_str());
+				}
+			}
+		}
+
+		//
+		// Lua binding for new data types and functions.
+		//
+
+		void bindLuaEvent() {
+			// Get our lua state.
+			sol::state& state = LuaManager::getInstance().getState();
+
+			// Create our event library.
+			state["event"] = LuaManager::getInstance().createTable();
+
+			state["event"]["register"] = [](sol::object eventType, sol::object callback, sol::optional<sol::table> options) {
+				event::validateEventArguments("event.register", eventType, callback);
+
+				std::string eventTypeString = eventType.as<std::string>();
+				sol::object filter = event::getRegistrationFilter(options);
+				double priority = getOptionalParam<double>(options, "priority", 0.0);
+				bool doOnce = getOptionalParam<bool>(options, "doOnce", false);
+
+				if (!event::registerCallback(eventTypeString.c_str(), callback, filter, priority, doOnce)) {
+					logStackTrace(("event.register: Attempted to register same '" + eventTypeString + "' event callback twice.").c_str());
+				}
+			};
+
+			state["event"]["unregister"] = [](sol::object eventType, sol::object callback, sol::optional<sol::table> options) {
+				event::validateEventArguments("event.unregister", eventType, callback);
+				return event::unregisterCallback(eventType.as<std::string>().c_str(), callback, event::getRegistrationFilter(options));
+			};
+
+			state["event"]["clear"] = [](sol::optional<std::string> eventType, sol::object filter) {
+				event::clear(eventType ? eventType.value().c_str() : nullptr, filter);
+			};
+
+			state["event"]["trigger"] = [](const char* eventType, sol::optional<sol::table> payload, sol::optional<sol::table> options) {
+				return event::trigger(eventType, payload ? payload.value() : sol::table(), options ? options.value() : sol::object(sol::nil));
+			};
+
+			// Allow opting into lazily resolved event payloads.
+			state["mwse"]["getLazyEventPayloads"] = &event::getLazyEventPayloads;
+			state["mwse"]["setLazyEventPayloads"] = &event::setLazyEventPayloads;
 		}
 	}
-}
\ No newline at end of file
+}
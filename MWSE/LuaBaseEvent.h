@@ -1,21 +1,115 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "sol.hpp"
 
+#include "LuaProfiler.h"
+
 namespace mwse {
 	namespace lua {
 		namespace event {
-
-			sol::object trigger(const char* eventType, sol::table eventData = sol::nil, sol::object eventFilter = sol::nil);
-
-			void clearObjectFilter(sol::object filterObject);
-
 			class BaseEvent {
 			public:
 				virtual const char* getEventName() { return nullptr; };
 				virtual sol::table createEventTable() { return sol::nil; };
 				virtual sol::object getEventOptions() { return sol::nil; }
 			};
+
+			// A single registered event callback.
+			struct EventCallback {
+				sol::protected_function callback;
+				double priority;
+				bool doOnce;
+				profiler::CallbackStatistics* statistics;
+			};
+
+			// Callback lists are copy-on-write. A trigger holds onto the list it started with, so
+			// callbacks can register or unregister during dispatch without breaking iteration.
+			typedef std::vector<EventCallback> EventCallbackList;
+			typedef std::shared_ptr<const EventCallbackList> EventCallbackListPointer;
+
+			// Hashable representation of a lua filter value. Equality follows lua's raw equality, the
+			// same rules that applied when filters were used as lua table keys.
+			struct EventFilterKey {
+				sol::type type;
+				double number;
+				std::string string;
+				const void* pointer;
+
+				EventFilterKey(sol::object filter);
+				bool operator==(const EventFilterKey& other) const;
+			};
+
+			struct EventFilterKeyHasher {
+				size_t operator()(const EventFilterKey& key) const;
+			};
+
+			struct FilteredEventCallbacks {
+				// Kept to hold a reference to the filter object, so its address can't be reused.
+				sol::object filter;
+				EventCallbackListPointer callbacks;
+			};
+
+			// All callbacks registered to a single event type. These are never destroyed once created,
+			// so references to them can be safely cached.
+			struct EventCallbacks {
+				EventCallbackListPointer general;
+				std::unordered_map<EventFilterKey, FilteredEventCallbacks, EventFilterKeyHasher> filtered;
+
+				// Looked up the first time the event is profiled, so dispatch doesn't need to look it up by name.
+				mutable profiler::EventStatistics* statistics = nullptr;
+
+				bool hasListeners() const;
+				EventCallbackListPointer getFilteredCallbacks(sol::object filter) const;
+			};
+
+			// Access to the native callback registry.
+			EventCallbacks& getEventCallbacks(const char* eventType);
+			bool hasListeners(const char* eventType);
+			bool registerCallback(const char* eventType, sol::protected_function callback, sol::object filter = sol::nil, double priority = 0.0, bool doOnce = false);
+			bool unregisterCallback(const char* eventType, sol::protected_function callback, sol::object filter = sol::nil);
+			void clear(const char* eventType, sol::object filter = sol::nil);
+			void clearObjectFilter(sol::object filterObject);
+			void clearAll();
+
+			// Raises a native event. No event table is created if nothing is listening for it.
+			sol::object trigger(BaseEvent* baseEvent);
+
+			// Raises an event using an already created payload.
+			sol::object trigger(const char* eventType, sol::table eventData = sol::nil, sol::object eventOptions = sol::nil);
+
+			// A payload field that is only converted into a lua object when a handler first reads it.
+			// Fields not read while the event is dispatching are nil afterwards. Instances are expected
+			// to have static storage duration.
+			struct LazyEventField {
+				typedef sol::object(*Resolver)(void* data);
+
+				const char* name;
+				Resolver resolver;
+
+				LazyEventField(const char* name, Resolver resolver);
+			};
+
+			// Commonly used lazy fields.
+			extern const LazyEventField lazyMobileField;
+			extern const LazyEventField lazyReferenceField;
+
+			// Toggles lazily materialized event payloads.
+			bool getLazyEventPayloads();
+			void setLazyEventPayloads(bool enabled);
+
+			// Creates an event table able to hold lazy fields. If lazy payloads are disabled, this is a plain table.
+			sol::table createLazyEventTable(int expectedFields = 0);
+
+			// Sets a field on a table made with createLazyEventTable. If lazy payloads are disabled, it is resolved now.
+			void setLazyEventField(sol::table& eventData, const LazyEventField& field, void* data);
 		}
+
+		// Create all the necessary lua binding for the event API.
+		void bindLuaEvent();
 	}
 }
@@ -10,6 +10,14 @@
 namespace mwse {
 	namespace lua {
 		namespace event {
+			static const LazyEventField lazyItemField("item", [](void* data) {
+				return makeLuaObject(static_cast<TES3::BaseObject*>(data));
+			});
+
+			static const LazyEventField lazyItemDataField("itemData", [](void* data) {
+				return sol::make_object(LuaManager::getInstance().getState(), static_cast<TES3::ItemData*>(data));
+			});
+
 			CalculateBarterPriceEvent::CalculateBarterPriceEvent(TES3::MobileActor * mobileActor, int basePrice, int price, bool buying, int count, TES3::EquipmentStack* stack) :
 				ObjectFilteredEvent("calcBarterPrice", mobileActor->reference),
 				m_MobileActor(mobileActor),
@@ -23,16 +31,16 @@ namespace mwse {
 			}
 
 			sol::table CalculateBarterPriceEvent::createEventTable() {
-				sol::table eventData = LuaManager::getInstance().createTable();
+				sol::table eventData = createLazyEventTable(8);
 
-				eventData["mobile"] = makeLuaObject(m_MobileActor);
+				setLazyEventField(eventData, lazyMobileField, m_MobileActor);
 				if (m_MobileActor) {
-					eventData["reference"] = makeLuaObject(m_MobileActor->reference);
+					setLazyEventField(eventData, lazyReferenceField, m_MobileActor->reference);
 				}
 
 				if (m_Stack) {
-					eventData["item"] = makeLuaObject(m_Stack->object);
-					eventData["itemData"] = m_Stack->variables;
+					setLazyEventField(eventData, lazyItemField, m_Stack->object);
+					setLazyEventField(eventData, lazyItemDataField, m_Stack->variables);
 				}
 
 				eventData["basePrice"] = m_BasePrice;
@@ -42,6 +50,11 @@ namespace mwse {
 
 				return eventData;
 			}
+
+			bool CalculateBarterPriceEvent::getEventEnabled() {
+				static const EventCallbacks& callbacks = getEventCallbacks("calcBarterPrice");
+				return callbacks.hasListeners();
+			}
 		}
 	}
 }
@@ -10,6 +10,9 @@ namespace mwse {
 				CalculateBarterPriceEvent(TES3::MobileActor * mobileActor, int basePrice, int price, bool buying, int count = 1, TES3::EquipmentStack* item = nullptr);
 				sol::table createEventTable();
 
+				// Fast check for any listeners, to avoid creating the event at all.
+				static bool getEventEnabled();
+
 			protected:
 				TES3::MobileActor* m_MobileActor;
 				int m_BasePrice;
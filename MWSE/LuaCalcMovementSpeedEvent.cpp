@@ -9,45 +9,56 @@
 namespace mwse {
 	namespace lua {
 		namespace event {
+			// Derive event name from its type.
+			static const char* getMovementEventName(CalculateMovementSpeed::MovementType type) {
+				switch (type) {
+				case CalculateMovementSpeed::Move:
+					return "calcMoveSpeed";
+				case CalculateMovementSpeed::Walk:
+					return "calcWalkSpeed";
+				case CalculateMovementSpeed::Run:
+					return "calcRunSpeed";
+				case CalculateMovementSpeed::Swim:
+					return "calcSwimSpeed";
+				case CalculateMovementSpeed::SwimRun:
+					return "calcSwimRunSpeed";
+				case CalculateMovementSpeed::Fly:
+					return "calcFlySpeed";
+				}
+				return nullptr;
+			}
+
 			CalculateMovementSpeed::CalculateMovementSpeed(MovementType type, TES3::MobileActor * mobile, float speed) :
-				ObjectFilteredEvent(NULL, mobile->reference),
+				ObjectFilteredEvent(getMovementEventName(type), mobile->reference),
+				m_Type(type),
 				m_MobileActor(mobile),
 				m_Speed(speed)
 			{
-				// Derive event name from its type.
-				switch (type) {
-				case Move:
-					m_EventName = "calcMoveSpeed";
-					break;
-				case Walk:
-					m_EventName = "calcWalkSpeed";
-					break;
-				case Run:
-					m_EventName = "calcRunSpeed";
-					break;
-				case Swim:
-					m_EventName = "calcSwimSpeed";
-					break;
-				case SwimRun:
-					m_EventName = "calcSwimRunSpeed";
-					break;
-				case Fly:
-					m_EventName = "calcFlySpeed";
-					break;
-				}
+
 			}
 
 			sol::table CalculateMovementSpeed::createEventTable() {
-				sol::state& state = LuaManager::getInstance().getState();
-				sol::table eventData = LuaManager::getInstance().createTable();
+				sol::table eventData = createLazyEventTable(4);
 
 				eventData["type"] = m_Type;
 				eventData["speed"] = m_Speed;
-				eventData["mobile"] = makeLuaObject(m_MobileActor);
-				eventData["reference"] = makeLuaObject(m_MobileActor->reference);
+				setLazyEventField(eventData, lazyMobileField, m_MobileActor);
+				setLazyEventField(eventData, lazyReferenceField, m_MobileActor->reference);
 
 				return eventData;
 			}
+
+			bool CalculateMovementSpeed::getEventEnabled(MovementType type) {
+				static const EventCallbacks* callbacks[] = {
+					&getEventCallbacks(getMovementEventName(Move)),
+					&getEventCallbacks(getMovementEventName(Walk)),
+					&getEventCallbacks(getMovementEventName(Run)),
+					&getEventCallbacks(getMovementEventName(Swim)),
+					&getEventCallbacks(getMovementEventName(SwimRun)),
+					&getEventCallbacks(getMovementEventName(Fly)),
+				};
+				return callbacks[type]->hasListeners();
+			}
 		}
 	}
 }
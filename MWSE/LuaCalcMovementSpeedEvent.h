@@ -19,6 +19,9 @@ namespace mwse {
 				CalculateMovementSpeed(MovementType type, TES3::MobileActor * mobile, float speed);
 				sol::table createEventTable();
 
+				// Fast check for any listeners, to avoid creating the event at all.
+				static bool getEventEnabled(MovementType type);
+
 			protected:
 				MovementType m_Type;
 				TES3::MobileActor * m_MobileActor;
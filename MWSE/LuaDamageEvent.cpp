@@ -18,15 +18,19 @@ namespace mwse {
 			}
 
 			sol::table DamageEvent::createEventTable() {
-				sol::state& state = LuaManager::getInstance().getState();
-				sol::table eventData = LuaManager::getInstance().createTable();
+				sol::table eventData = createLazyEventTable(3);
 
-				eventData["mobile"] = makeLuaObject(m_MobileActor);
-				eventData["reference"] = makeLuaObject(m_MobileActor->reference);
+				setLazyEventField(eventData, lazyMobileField, m_MobileActor);
+				setLazyEventField(eventData, lazyReferenceField, m_MobileActor->reference);
 				eventData["damage"] = m_Damage;
 
 				return eventData;
 			}
+
+			bool DamageEvent::getEventEnabled() {
+				static const EventCallbacks& callbacks = getEventCallbacks("damage");
+				return callbacks.hasListeners();
+			}
 		}
 	}
 }
@@ -10,6 +10,9 @@ namespace mwse {
 				DamageEvent(TES3::MobileActor* mobileActor, float damage);
 				sol::table createEventTable();
 
+				// Fast check for any listeners, to avoid creating the event at all.
+				static bool getEventEnabled();
+
 			protected:
 				TES3::MobileActor * m_MobileActor;
 				float m_Damage;
@@ -22,6 +22,11 @@ namespace mwse {
 
 				return eventData;
 			}
+
+			bool FrameEvent::getEventEnabled() {
+				static const EventCallbacks& callbacks = getEventCallbacks("enterFrame");
+				return callbacks.hasListeners();
+			}
 		}
 	}
 }
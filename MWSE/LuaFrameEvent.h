@@ -11,6 +11,9 @@ namespace mwse {
 				FrameEvent(float delta, bool menuMode);
 				sol::table createEventTable();
 
+				// Fast check for any listeners, to avoid creating the event at all.
+				static bool getEventEnabled();
+
 			protected:
 				bool m_MenuMode;
 				float m_Delta;
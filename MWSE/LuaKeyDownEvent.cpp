@@ -8,6 +8,11 @@ namespace mwse {
 			{
 				m_EventName = "keyDown";
 			}
+
+			bool KeyDownEvent::getEventEnabled() {
+				static const EventCallbacks& callbacks = getEventCallbacks("keyDown");
+				return callbacks.hasListeners();
+			}
 		}
 	}
 }
@@ -39,6 +39,11 @@ namespace mwse {
 
 				return options;
 			}
+
+			bool KeyEvent::getEventEnabled() {
+				static const EventCallbacks& callbacks = getEventCallbacks("key");
+				return callbacks.hasListeners();
+			}
 		}
 	}
 }
@@ -12,6 +12,9 @@ namespace mwse {
 				sol::table createEventTable();
 				sol::object getEventOptions();
 
+				// Fast check for any listeners, to avoid creating the event at all.
+				static bool getEventEnabled();
+
 			protected:
 				int m_KeyCode;
 				bool m_Pressed;
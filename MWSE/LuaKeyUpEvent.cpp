@@ -8,6 +8,11 @@ namespace mwse {
 			{
 				m_EventName = "keyUp";
 			}
+
+			bool KeyUpEvent::getEventEnabled() {
+				static const EventCallbacks& callbacks = getEventCallbacks("keyUp");
+				return callbacks.hasListeners();
+			}
 		}
 	}
 }
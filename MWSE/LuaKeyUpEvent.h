@@ -8,6 +8,9 @@ namespace mwse {
 			class KeyUpEvent : public KeyEvent {
 			public:
 				KeyUpEvent(int keyCode, bool controlDown, bool shiftDown, bool altDown, bool superDown);
+
+				// Fast check for any listeners, to avoid creating the event at all.
+				static bool getEventEnabled();
 			};
 		}
 	}
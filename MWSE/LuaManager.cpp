@@ -5,6 +5,11 @@
 #include "TES3Util.h"
 #include "MemoryUtil.h"
 #include "ScriptUtil.h"
+#include "StringUtil.h"
+#include "ReferenceSpatialIndex.h"
+#include "ObjectIdIndex.h"
+#include "ObjectTypeIndex.h"
+#include "InventoryStackIndex.h"
 #include "UIUtil.h"
 #include "MWSEDefs.h"
 #include "BuildDate.h"
@@ -12,6 +17,7 @@
 #include "sol.hpp"
 
 #include "LuaTimer.h"
+#include "LuaProfiler.h"
 
 #include "LuaScript.h"
 
@@ -49,6 +55,7 @@
 #include "TES3WorldController.h"
 
 // Lua binding files. These are split out rather than kept here to help with compile times.
+#include "ArrayUtilLua.h"
 #include "StackLua.h"
 #include "ScriptUtilLua.h"
 #include "StringUtilLua.h"
@@ -307,6 +314,10 @@ namespace mwse {
 			luaState["mwscript"] = createTable();
 			luaState["mge"] = createTable();
 
+			// Expose the event system.
+			bindLuaEvent();
+			bindLuaProfiler();
+
 			// Expose timers.
 			bindLuaTimer();
 			luaState["mwse"]["realTimers"] = realTimers;
@@ -568,11 +579,26 @@ namespace mwse {
 			// Run the function before raising our event.
 			worldController->mainLoopBeforeInput();
 
+			// Count frames for the event profiler, and dump its statistics if needed.
+			profiler::onFrame();
+
+			// References may have moved since the last frame.
+			tes3::ReferenceSpatialIndex::getInstance().onFrame();
+
+			// The engine may have changed inventories behind our backs.
+			tes3::InventoryStackIndex::getInstance().onFrame();
+
 			// Fire off any button pressed events if we had one queued.
 			LuaManager& luaManager = LuaManager::getInstance();
 			if (tes3::ui::getButtonPressedIndex() != -1) {
 				luaManager.triggerButtonPressed();
 			}
+
+			// Run any events that were raised on the background thread since the last frame.
+			luaManager.triggerBackgroundThreadEvents();
+
+			// Virtual lists that were scrolled or resized need new rows.
+			updateVirtualLists();
 			
 			// Update timer controllers.
 			double highResolutionTimestamp = worldController->getHighPrecisionSimulationTimestamp();
@@ -587,15 +613,18 @@ namespace mwse {
 			// Has our cell changed?
 			TES3::DataHandler * dataHandler = TES3::DataHandler::get();
 			if (dataHandler->cellChanged) {
+				tes3::ReferenceSpatialIndex::getInstance().invalidate();
 				LuaManager::getInstance().triggerEvent(new event::CellChangedEvent(dataHandler->currentCell, lastCell));
 				lastCell = dataHandler->currentCell;
 			}
 
 			// Send off our enterFrame event always.
-			luaManager.triggerEvent(new event::FrameEvent(worldController->deltaTime, worldController->flagMenuMode));
+			if (event::FrameEvent::getEventEnabled()) {
+				luaManager.triggerEvent(new event::FrameEvent(worldController->deltaTime, worldController->flagMenuMode));
+			}
 
 			// If we're not in menu mode, send off the simulate event.
-			if (!worldController->flagMenuMode) {
+			if (!worldController->flagMenuMode && event::SimulateEvent::getEventEnabled()) {
 				luaManager.triggerEvent(new event::SimulateEvent(worldController->deltaTime, highResolutionTimestamp));
 			}
 		}
@@ -671,6 +700,12 @@ namespace mwse {
 
 			// Extra things we want to do if we're successfully loading.
 			if (loaded == TES3::LoadGameResult::Success) {
+				// String ids can't be stored across saves, so free any strings left over from before the load.
+				mwse::string::store::collect();
+
+				tes3::ReferenceSpatialIndex::getInstance().invalidate();
+				tes3::ObjectIdIndex::getInstance().clear();
+
 				TES3::DataHandler * dataHandler = TES3::DataHandler::get();
 				LuaManager::getInstance().triggerEvent(new event::CellChangedEvent(dataHandler->currentCell, NULL));
 				lastCell = dataHandler->currentCell;
@@ -685,6 +720,12 @@ namespace mwse {
 
 			// Fire off a cell changed event as well, and update the cached last cell.
 			if (loaded == TES3::LoadGameResult::Success) {
+				// String ids can't be stored across saves, so free any strings left over from before the load.
+				mwse::string::store::collect();
+
+				tes3::ReferenceSpatialIndex::getInstance().invalidate();
+				tes3::ObjectIdIndex::getInstance().clear();
+
 				TES3::DataHandler * dataHandler = TES3::DataHandler::get();
 				LuaManager::getInstance().triggerEvent(new event::CellChangedEvent(dataHandler->currentCell, NULL));
 				lastCell = dataHandler->currentCell;
@@ -708,6 +749,8 @@ namespace mwse {
 			// Fire off the loaded/cellChanged events.
 			LuaManager& luaManager = LuaManager::getInstance();
 			lastCell = TES3::DataHandler::get()->currentCell;
+			tes3::ReferenceSpatialIndex::getInstance().invalidate();
+			tes3::ObjectIdIndex::getInstance().clear();
 			luaManager.triggerEvent(new event::LoadedGameEvent(nullptr, false, true));
 			luaManager.triggerEvent(new event::CellChangedEvent(lastCell, nullptr));
 		}
@@ -866,16 +909,24 @@ namespace mwse {
 			LuaManager& luaManager = LuaManager::getInstance();
 			for (size_t i = 0; i < 256; i++) {
 				if (inputController->isKeyPressedThisFrame(i)) {
-					luaManager.triggerEvent(new event::KeyDownEvent(i, controlDown, shiftDown, altDown, superDown));
+					if (event::KeyDownEvent::getEventEnabled()) {
+						luaManager.triggerEvent(new event::KeyDownEvent(i, controlDown, shiftDown, altDown, superDown));
+					}
 
 					// TODO: Remove! Deprecated generic key event.
-					luaManager.triggerEvent(new event::KeyEvent(i, true, controlDown, shiftDown, altDown, superDown));
+					if (event::KeyEvent::getEventEnabled()) {
+						luaManager.triggerEvent(new event::KeyEvent(i, true, controlDown, shiftDown, altDown, superDown));
+					}
 				}
 				else if (inputController->isKeyReleasedThisFrame(i)) {
-					luaManager.triggerEvent(new event::KeyUpEvent(i, controlDown, shiftDown, altDown, superDown));
+					if (event::KeyUpEvent::getEventEnabled()) {
+						luaManager.triggerEvent(new event::KeyUpEvent(i, controlDown, shiftDown, altDown, superDown));
+					}
 
 					// TODO: Remove! Deprecated generic key event.
-					luaManager.triggerEvent(new event::KeyEvent(i, false, controlDown, shiftDown, altDown, superDown));
+					if (event::KeyEvent::getEventEnabled()) {
+						luaManager.triggerEvent(new event::KeyEvent(i, false, controlDown, shiftDown, altDown, superDown));
+					}
 				}
 			}
 
@@ -892,7 +943,7 @@ namespace mwse {
 			// Look at mouse axis events.
 			LONG mouseDeltaX = inputController->mouseState.lX;
 			LONG mouseDeltaY = inputController->mouseState.lY;
-			if (mouseDeltaX || mouseDeltaY) {
+			if ((mouseDeltaX || mouseDeltaY) && event::MouseAxisEvent::getEventEnabled()) {
 				luaManager.triggerEvent(new event::MouseAxisEvent(mouseDeltaX, mouseDeltaY, controlDown, shiftDown, altDown, superDown));
 			}
 
@@ -957,14 +1008,16 @@ namespace mwse {
 		//
 
 		void __cdecl MagicEffectDispatch(TES3::EffectID::EffectID effectId, TES3::MagicSourceInstance * sourceInstance, float deltaTime, TES3::MagicEffectInstance * effectInstance, int effectIndex) {
-			sol::table eventData = LuaManager::getInstance().triggerEvent(new event::SpellTickEvent(effectId, sourceInstance, deltaTime, effectInstance, effectIndex));
-			if (eventData.valid()) {
-				if (eventData["block"] == true) {
-					// We still need the main effect event function to be called for visual effects and durations to be handled.
-					int flags = (tes3::getBaseEffectFlags()[effectId] >> 12) & 0xFFFFFF01;
-					int value = 0;
-					reinterpret_cast<char(__cdecl *)(TES3::MagicSourceInstance *, float, TES3::MagicEffectInstance *, int, bool, int, int *, DWORD, int, bool(__cdecl *)(void *, void *, int))>(0x518460)(sourceInstance, deltaTime, effectInstance, effectIndex, true, flags, &value, 0x7886F0, 0x1C, nullptr);
-					return;
+			if (event::SpellTickEvent::getEventEnabled()) {
+				sol::table eventData = LuaManager::getInstance().triggerEvent(new event::SpellTickEvent(effectId, sourceInstance, deltaTime, effectInstance, effectIndex));
+				if (eventData.valid()) {
+					if (eventData["block"] == true) {
+						// We still need the main effect event function to be called for visual effects and durations to be handled.
+						int flags = (tes3::getBaseEffectFlags()[effectId] >> 12) & 0xFFFFFF01;
+						int value = 0;
+						reinterpret_cast<char(__cdecl *)(TES3::MagicSourceInstance *, float, TES3::MagicEffectInstance *, int, bool, int, int *, DWORD, int, bool(__cdecl *)(void *, void *, int))>(0x518460)(sourceInstance, deltaTime, effectInstance, effectIndex, true, flags, &value, 0x7886F0, 0x1C, nullptr);
+						return;
+					}
 				}
 			}
 
@@ -1112,6 +1165,16 @@ namespace mwse {
 			// Clear the object from the userdata cache.
 			LuaManager::getInstance().removeUserdataFromCache(object);
 
+			// Make sure our indexes don't hold on to deleted objects.
+			tes3::ObjectIdIndex::getInstance().onObjectRemoved(object);
+			if (object->objectType == TES3::ObjectType::Reference) {
+				tes3::ReferenceSpatialIndex::getInstance().invalidate();
+			}
+			else {
+				// Leaves a null entry behind, so lists being iterated keep their layout.
+				tes3::ObjectTypeIndex::getInstance().onObjectRemoved(static_cast<TES3::Object*>(object));
+			}
+
 			// Let the object finally die.
 			return reinterpret_cast<TES3::BaseObject*(__thiscall *)(TES3::BaseObject*)>(TES3_BaseObject_destructor)(object);
 		}
@@ -1475,9 +1538,11 @@ namespace mwse {
 				count = std::abs(basePrice / OnCalculateBarterPrice_value);
 			}
 
-			sol::table result = LuaManager::getInstance().triggerEvent(new event::CalculateBarterPriceEvent(mobile, basePrice, price, buying, count, OnCalculateBarterPrice_stack));
-			if (result.valid()) {
-				price = result["price"];
+			if (event::CalculateBarterPriceEvent::getEventEnabled()) {
+				sol::table result = LuaManager::getInstance().triggerEvent(new event::CalculateBarterPriceEvent(mobile, basePrice, price, buying, count, OnCalculateBarterPrice_stack));
+				if (result.valid()) {
+					price = result["price"];
+				}
 			}
 
 			return price;
@@ -2358,6 +2423,16 @@ namespace mwse {
 			return luaState.create_table();
 		}
 
+		sol::table LuaManager::createTable(int arraySize, int hashSize) {
+#if _DEBUG
+			auto dataHandler = TES3::DataHandler::get();
+			if (dataHandler != nullptr && dataHandler->mainThreadID != GetCurrentThreadId()) {
+				throw std::exception("Cannot be called from outside the main thread.");
+			}
+#endif
+			return luaState.create_table(arraySize, hashSize);
+		}
+
 		void LuaManager::hook() {
 			// Execute mwse_init.lua
 			sol::protected_function_result result = luaState.safe_script_file("Data Files/MWSE/core/mwse_init.lua");
@@ -2368,6 +2443,7 @@ namespace mwse {
 			}
 
 			// Bind libraries.
+			bindArrayUtil();
 			bindMWSEStack();
 			bindScriptUtil();
 			bindStringUtil();
@@ -3220,9 +3296,11 @@ namespace mwse {
 			// closing mid-execution.
 			scriptOverrides.clear();
 
-			userdataMapMutex.lock();
+			// Release any event callbacks while the lua state is still valid.
+			event::clearAll();
+
+			processPendingUserdataRemovals();
 			userdataCache.clear();
-			userdataMapMutex.unlock();
 		}
 
 		TES3::Script* LuaManager::getCurrentScript() {
@@ -3247,20 +3325,19 @@ namespace mwse {
 
 			// If we're on the main thread, immediately execute the event
 			if (dataHandler == nullptr || threadId == dataHandler->mainThreadID) {
-				// Use this opportunity to check for background events that need to run.
-				triggerBackgroundThreadEvents();
-
 				// Execute the original event.
-				sol::object response = event::trigger(baseEvent->getEventName(), baseEvent->createEventTable(), baseEvent->getEventOptions());
+				sol::object response = event::trigger(baseEvent);
 				delete baseEvent;
 				return response;
 			}
 
 			// If we're not on the main thread, queue the event to run once we are.
 			else if (threadId == dataHandler->backgroundThreadID) {
-				backgroundThreadEventsMutex.lock();
-				backgroundThreadEvents.push(baseEvent);
-				backgroundThreadEventsMutex.unlock();
+				if (backgroundThreadEventsOverflowed || !backgroundThreadEvents.tryPush(baseEvent)) {
+					std::lock_guard<std::mutex> lock(backgroundThreadEventsOverflowMutex);
+					backgroundThreadEventsOverflow.push(baseEvent);
+					backgroundThreadEventsOverflowed = true;
+				}
 			}
 
 			// If we're not on the main thread or the background thread we don't know WTF is going on.
@@ -3272,19 +3349,32 @@ namespace mwse {
 		}
 
 		void LuaManager::triggerBackgroundThreadEvents() {
-			backgroundThreadEventsMutex.lock();
-
-			while (backgroundThreadEvents.size() > 0) {
-				// Pop the event off the stack.
-				event::BaseEvent* baseEvent = backgroundThreadEvents.front();
-				backgroundThreadEvents.pop();
+			// Quick check that doesn't touch the queue's contents.
+			if (backgroundThreadEvents.empty() && !backgroundThreadEventsOverflowed) {
+				return;
+			}
 
-				// Trigger it.
-				event::trigger(baseEvent->getEventName(), baseEvent->createEventTable(), baseEvent->getEventOptions());
+			event::BaseEvent* baseEvent = nullptr;
+			while (backgroundThreadEvents.tryPop(baseEvent)) {
+				event::trigger(baseEvent);
 				delete baseEvent;
 			}
 
-			backgroundThreadEventsMutex.unlock();
+			// Anything that spilled over is newer than what was in the queue.
+			if (backgroundThreadEventsOverflowed) {
+				std::queue<event::BaseEvent*> overflow;
+				{
+					std::lock_guard<std::mutex> lock(backgroundThreadEventsOverflowMutex);
+					overflow.swap(backgroundThreadEventsOverflow);
+					backgroundThreadEventsOverflowed = false;
+				}
+
+				while (!overflow.empty()) {
+					event::trigger(overflow.front());
+					delete overflow.front();
+					overflow.pop();
+				}
+			}
 		}
 
 		void LuaManager::setButtonPressedCallback(sol::optional<sol::protected_function> callback) {
@@ -3308,79 +3398,86 @@ namespace mwse {
 		}
 
 		sol::object LuaManager::getCachedUserdata(TES3::BaseObject* object) {
-			userdataMapMutex.lock();
-
-			sol::object result = sol::nil;
+			processPendingUserdataRemovals();
 
-			UserdataMap::iterator searchResult = userdataCache.find((unsigned long)object);
-			if (searchResult != userdataCache.end()) {
-				result = searchResult->second;
+			const sol::object* result = userdataCache.find(object);
+			if (result == nullptr) {
+				return sol::nil;
 			}
-
-			userdataMapMutex.unlock();
-
-			return result;
+			return *result;
 		}
 
 		sol::object LuaManager::getCachedUserdata(TES3::MobileObject* object) {
-			userdataMapMutex.lock();
-
-			sol::object result = sol::nil;
+			processPendingUserdataRemovals();
 
-			UserdataMap::iterator searchResult = userdataCache.find((unsigned long)object);
-			if (searchResult != userdataCache.end()) {
-				result = searchResult->second;
+			const sol::object* result = userdataCache.find(object);
+			if (result == nullptr) {
+				return sol::nil;
 			}
-
-			userdataMapMutex.unlock();
-
-			return result;
+			return *result;
 		}
 
 		void LuaManager::insertUserdataIntoCache(TES3::BaseObject* object, sol::object luaObject) {
-			userdataMapMutex.lock();
-			userdataCache[(unsigned long)object] = luaObject;
-			userdataMapMutex.unlock();
+			userdataCache.insert(object, luaObject);
 		}
 
 		void LuaManager::insertUserdataIntoCache(TES3::MobileObject* object, sol::object luaObject) {
-			userdataMapMutex.lock();
-			userdataCache[(unsigned long)object] = luaObject;
-			userdataMapMutex.unlock();
+			userdataCache.insert(object, luaObject);
 		}
 
 		void LuaManager::removeUserdataFromCache(TES3::BaseObject* object) {
-			userdataMapMutex.lock();
+			removeUserdataFromCache(static_cast<const void*>(object));
+		}
 
-			if (!userdataCache.empty()) {
-				UserdataMap::iterator it = userdataCache.find((unsigned long)object);
-				if (it != userdataCache.end()) {
-					// Clear any events that make use of this object.
-					event::clearObjectFilter(it->second);
+		void LuaManager::removeUserdataFromCache(TES3::MobileObject* object) {
+			removeUserdataFromCache(static_cast<const void*>(object));
+		}
 
-					// Remove it from the cache.
-					userdataCache.erase(it);
+		void LuaManager::removeUserdataFromCache(const void* object) {
+			// Objects deleted off the main thread are removed later, as it isn't safe to touch lua here.
+			TES3::DataHandler* dataHandler = TES3::DataHandler::get();
+			if (dataHandler != nullptr && GetCurrentThreadId() != dataHandler->mainThreadID) {
+				if (pendingUserdataRemovalsOverflowed || !pendingUserdataRemovals.tryPush(object)) {
+					std::lock_guard<std::mutex> lock(pendingUserdataRemovalsOverflowMutex);
+					pendingUserdataRemovalsOverflow.push_back(object);
+					pendingUserdataRemovalsOverflowed = true;
 				}
+				return;
+			}
+
+			if (userdataCache.empty()) {
+				return;
 			}
 
-			userdataMapMutex.unlock();
+			sol::object removed = userdataCache.remove(object);
+			if (removed != sol::nil) {
+				// Clear any events that make use of this object.
+				event::clearObjectFilter(removed);
+			}
 		}
 
-		void LuaManager::removeUserdataFromCache(TES3::MobileObject* object) {
-			userdataMapMutex.lock();
+		void LuaManager::processPendingUserdataRemovals() {
+			if (pendingUserdataRemovals.empty() && !pendingUserdataRemovalsOverflowed) {
+				return;
+			}
 
-			if (!userdataCache.empty()) {
-				UserdataMap::iterator it = userdataCache.find((unsigned long)object);
-				if (it != userdataCache.end()) {
-					// Clear any events that make use of this object.
-					event::clearObjectFilter(it->second);
+			const void* object = nullptr;
+			while (pendingUserdataRemovals.tryPop(object)) {
+				removeUserdataFromCache(object);
+			}
 
-					// Remove it from the cache.
-					userdataCache.erase(it);
+			if (pendingUserdataRemovalsOverflowed) {
+				std::vector<const void*> overflow;
+				{
+					std::lock_guard<std::mutex> lock(pendingUserdataRemovalsOverflowMutex);
+					overflow.swap(pendingUserdataRemovalsOverflow);
+					pendingUserdataRemovalsOverflowed = false;
 				}
-			}
 
-			userdataMapMutex.unlock();
+				for (const void* overflowObject : overflow) {
+					removeUserdataFromCache(overflowObject);
+				}
+			}
 		}
 
 		void LuaManager::updateTimers(float deltaTime, double simulationTimestamp, bool simulating) {
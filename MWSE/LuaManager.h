@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include <queue>
 
+#include <atomic>
 #include <mutex>
 
 #include "TES3Util.h"
@@ -11,10 +12,12 @@
 
 #include "LuaBaseEvent.h"
 
+#include "LuaUserdataCache.h"
+
+#include "LockFreeQueue.h"
+
 namespace mwse {
 	namespace lua {
-		typedef std::unordered_map<unsigned long, sol::object> UserdataMap;
-
 		class TimerController;
 
 		enum class TimerType {
@@ -34,6 +37,7 @@ namespace mwse {
 			sol::state& getState();
 
 			sol::table createTable();
+			sol::table createTable(int arraySize, int hashSize);
 
 			// Uses the MemoryUtil library to create the necessary injections into Morrowind.
 			void hook();
@@ -49,13 +53,15 @@ namespace mwse {
 
 			// Event management.
 			sol::object triggerEvent(event::BaseEvent*);
+			// Runs any events queued from the background thread. Called once per frame.
 			void triggerBackgroundThreadEvents();
 
 			// Handle our button pressed callbacks. There can only be one at a time.
 			void setButtonPressedCallback(sol::optional<sol::protected_function>);
 			void triggerButtonPressed();
 
-			// Guarded access to the userdata cache.
+			// Access to the userdata cache. Lookups and insertions must happen on the main thread. Removals
+			// from other threads are deferred until the main thread next touches the cache.
 			sol::object getCachedUserdata(TES3::BaseObject*);
 			sol::object getCachedUserdata(TES3::MobileObject*);
 			void insertUserdataIntoCache(TES3::BaseObject*, sol::object);
@@ -87,16 +93,30 @@ namespace mwse {
 			TES3::Script* currentScript = NULL;
 			TES3::Reference* currentReference = NULL;
 
-			//
-			std::mutex backgroundThreadEventsMutex;
-			std::queue<event::BaseEvent*> backgroundThreadEvents;
+			// Events raised on the background thread, waiting for the main thread to run them.
+			LockFreeQueue<event::BaseEvent*, 1024> backgroundThreadEvents;
+
+			// If the background thread fills the queue, such as during a long load, further events
+			// spill over into a locked queue until the main thread catches up.
+			std::atomic<bool> backgroundThreadEventsOverflowed { false };
+			std::mutex backgroundThreadEventsOverflowMutex;
+			std::queue<event::BaseEvent*> backgroundThreadEventsOverflow;
 
 			// Storage for our current button pressed callback.
 			sol::protected_function buttonPressedCallback = sol::nil;
 
-			// 
-			std::mutex userdataMapMutex;
-			UserdataMap userdataCache;
+			// Cache of userdata for game objects, so each object has a single lua representation.
+			UserdataCache userdataCache;
+
+			// Objects deleted on the background thread, waiting to be removed from the cache.
+			LockFreeQueue<const void*, 4096> pendingUserdataRemovals;
+			std::atomic<bool> pendingUserdataRemovalsOverflowed { false };
+			std::mutex pendingUserdataRemovalsOverflowMutex;
+			std::vector<const void*> pendingUserdataRemovalsOverflow;
+
+			// Applies any deferred removals to the cache.
+			void processPendingUserdataRemovals();
+			void removeUserdataFromCache(const void* object);
 
 			// Timers.
 			std::shared_ptr<TimerController> gameTimers;
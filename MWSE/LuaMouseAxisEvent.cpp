@@ -30,6 +30,11 @@ namespace mwse {
 
 				return eventData;
 			}
+
+			bool MouseAxisEvent::getEventEnabled() {
+				static const EventCallbacks& callbacks = getEventCallbacks("mouseAxis");
+				return callbacks.hasListeners();
+			}
 		}
 	}
 }
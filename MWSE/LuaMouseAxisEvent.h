@@ -10,6 +10,9 @@ namespace mwse {
 				MouseAxisEvent(int deltaX, int deltaY, bool controlDown, bool shiftDown, bool altDown, bool superDown);
 				sol::table createEventTable();
 
+				// Fast check for any listeners, to avoid creating the event at all.
+				static bool getEventEnabled();
+
 			protected:
 				int m_DeltaX;
 				int m_DeltaY;
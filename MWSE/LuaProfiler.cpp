@@ -0,0 +1,260 @@
+#include "LuaProfiler.h"
+
+#include "LuaManager.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace mwse {
+	namespace lua {
+		namespace profiler {
+			//
+			// ProfilerStatistics
+			//
+
+			void ProfilerStatistics::addSample(double milliseconds) {
+				count++;
+				total += milliseconds;
+				if (milliseconds > maximum) {
+					maximum = milliseconds;
+				}
+
+				// Keep a ring of the most recent samples.
+				if (samples.size() < SampleCount) {
+					samples.push_back(float(milliseconds));
+				}
+				else {
+					samples[nextSample] = float(milliseconds);
+					nextSample = (nextSample + 1) % SampleCount;
+				}
+			}
+
+			void ProfilerStatistics::reset() {
+				count = 0;
+				total = 0.0;
+				maximum = 0.0;
+				samples.clear();
+				nextSample = 0;
+			}
+
+			double ProfilerStatistics::getMean() const {
+				if (count == 0) {
+					return 0.0;
+				}
+				return total / count;
+			}
+
+			double ProfilerStatistics::getPercentile(double percentile) const {
+				if (samples.empty()) {
+					return 0.0;
+				}
+
+				std::vector<float> sorted = samples;
+				size_t index = std::min(sorted.size() - 1, size_t(percentile / 100.0 * sorted.size()));
+				std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+				return sorted[index];
+			}
+
+			//
+			// Profiler state.
+			//
+
+			static bool enabled = false;
+
+			// Frames that have passed since statistics were last reset.
+			static unsigned long long frameCount = 0;
+
+			// Periodic dumping to the log. An interval of zero disables it.
+			static double dumpInterval = 0.0;
+			static Clock::time_point lastDump;
+
+			// Event statistics, by event type. Map nodes are stable, so pointers to them can be cached.
+			static std::unordered_map<std::string, EventStatistics>& getAllEventStatistics() {
+				static std::unordered_map<std::string, EventStatistics> statistics;
+				return statistics;
+			}
+
+			bool getEnabled() {
+				return enabled;
+			}
+
+			void setEnabled(bool value) {
+				if (value && !enabled) {
+					lastDump = Clock::now();
+				}
+				enabled = value;
+			}
+
+			void reset() {
+				for (auto& eventItr : getAllEventStatistics()) {
+					eventItr.second.reset();
+					for (auto& callbackItr : eventItr.second.callbacks) {
+						callbackItr.second.reset();
+					}
+				}
+				frameCount = 0;
+				lastDump = Clock::now();
+			}
+
+			EventStatistics* getEventStatistics(const char* eventType) {
+				return &getAllEventStatistics()[eventType];
+			}
+
+			CallbackStatistics* getCallbackStatistics(const char* eventType, const sol::protected_function& callback) {
+				lua_State* L = callback.lua_state();
+
+				// Identify the callback by the location of its definition.
+				lua_Debug info;
+				callback.push();
+				if (lua_getinfo(L, ">S", &info) == 0) {
+					return nullptr;
+				}
+
+				std::string key = std::string(info.short_src) + ":" + std::to_string(info.linedefined);
+				auto& callbacks = getEventStatistics(eventType)->callbacks;
+				auto itr = callbacks.find(key);
+				if (itr != callbacks.end()) {
+					return &itr->second;
+				}
+
+				CallbackStatistics& statistics = callbacks[key];
+				statistics.source = info.short_src;
+				statistics.line = info.linedefined;
+				return &statistics;
+			}
+
+			void onFrame() {
+				if (!enabled) {
+					return;
+				}
+
+				frameCount++;
+
+				if (dumpInterval > 0.0) {
+					auto now = Clock::now();
+					if (getMilliseconds(lastDump, now) >= dumpInterval * 1000.0) {
+						dump();
+						lastDump = now;
+					}
+				}
+			}
+
+			static void dumpStatistics(const char* prefix, const std::string& name, const ProfilerStatistics& statistics) {
+				log::getLog() << prefix << name
+					<< ": count=" << statistics.count
+					<< " total=" << statistics.total
+					<< "ms mean=" << statistics.getMean()
+					<< "ms p99=" << statistics.getPercentile(99.0)
+					<< "ms max=" << statistics.maximum
+					<< "ms" << std::endl;
+			}
+
+			void dump() {
+				// Sort events by the total time spent in them, worst first.
+				std::vector<std::pair<const std::string*, const EventStatistics*>> events;
+				for (const auto& itr : getAllEventStatistics()) {
+					if (itr.second.count > 0) {
+						events.emplace_back(&itr.first, &itr.second);
+					}
+				}
+				std::sort(events.begin(), events.end(), [](const auto& a, const auto& b) {
+					return a.second->total > b.second->total;
+				});
+
+				auto& log = log::getLog();
+				log << "Event profiler statistics over " << frameCount << " frames:" << std::endl;
+				for (const auto& event : events) {
+					dumpStatistics("  ", *event.first, *event.second);
+					for (const auto& callback : event.second->callbacks) {
+						if (callback.second.count > 0) {
+							dumpStatistics("    ", callback.first, callback.second);
+						}
+					}
+				}
+			}
+
+			static sol::table createStatisticsTable(const ProfilerStatistics& statistics) {
+				sol::table result = LuaManager::getInstance().createTable();
+				result["count"] = statistics.count;
+				result["total"] = statistics.total;
+				result["mean"] = statistics.getMean();
+				result["p99"] = statistics.getPercentile(99.0);
+				result["max"] = statistics.maximum;
+				if (frameCount > 0) {
+					result["perFrame"] = statistics.total / frameCount;
+				}
+				return result;
+			}
+		}
+
+		void bindLuaProfiler() {
+			LuaManager& luaManager = LuaManager::getInstance();
+			sol::state& state = luaManager.getState();
+
+			sol::table profilerTable = luaManager.createTable();
+
+			profilerTable["getEnabled"] = []() {
+				return profiler::getEnabled();
+			};
+
+			profilerTable["setEnabled"] = [](bool enabled) {
+				profiler::setEnabled(enabled);
+			};
+
+			profilerTable["reset"] = []() {
+				profiler::reset();
+			};
+
+			profilerTable["dump"] = []() {
+				profiler::dump();
+			};
+
+			profilerTable["getDumpInterval"] = []() {
+				return profiler::dumpInterval;
+			};
+
+			profilerTable["setDumpInterval"] = [](double seconds) {
+				profiler::dumpInterval = std::max(seconds, 0.0);
+			};
+
+			profilerTable["getFrameCount"] = []() {
+				return profiler::frameCount;
+			};
+
+			profilerTable["getStatistics"] = [](sol::optional<std::string> eventType) {
+				LuaManager& luaManager = LuaManager::getInstance();
+				sol::table result = luaManager.createTable();
+				for (const auto& eventItr : profiler::getAllEventStatistics()) {
+					if (eventType && eventType.value() != eventItr.first) {
+						continue;
+					}
+
+					if (eventItr.second.count == 0) {
+						continue;
+					}
+
+					sol::table eventResult = profiler::createStatisticsTable(eventItr.second);
+					sol::table callbacks = luaManager.createTable();
+					for (const auto& callbackItr : eventItr.second.callbacks) {
+						if (callbackItr.second.count == 0) {
+							continue;
+						}
+
+						sol::table callbackResult = profiler::createStatisticsTable(callbackItr.second);
+						callbackResult["source"] = callbackItr.second.source;
+						callbackResult["line"] = callbackItr.second.line;
+						callbacks.add(callbackResult);
+					}
+					eventResult["callbacks"] = callbacks;
+
+					result[eventItr.first] = eventResult;
+				}
+				return result;
+			};
+
+			state["mwse"]["profiler"] = profilerTable;
+		}
+	}
+}
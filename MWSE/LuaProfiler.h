@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "sol.hpp"
+
+namespace mwse {
+	namespace lua {
+		namespace profiler {
+			typedef std::chrono::high_resolution_clock Clock;
+
+			// Timing statistics for a single profiled item. All times are in milliseconds.
+			struct ProfilerStatistics {
+				// Number of recent samples kept for percentile calculations.
+				static const size_t SampleCount = 512;
+
+				unsigned long long count = 0;
+				double total = 0.0;
+				double maximum = 0.0;
+				std::vector<float> samples;
+				size_t nextSample = 0;
+
+				void addSample(double milliseconds);
+				void reset();
+
+				double getMean() const;
+				double getPercentile(double percentile) const;
+			};
+
+			// Statistics for a single registered callback, identified by where it was defined.
+			struct CallbackStatistics : ProfilerStatistics {
+				std::string source;
+				int line = 0;
+			};
+
+			// Statistics for an event, and each callback that has run for it.
+			struct EventStatistics : ProfilerStatistics {
+				std::map<std::string, CallbackStatistics> callbacks;
+			};
+
+			bool getEnabled();
+			void setEnabled(bool enabled);
+
+			// Clears all collected statistics. Existing pointers to statistics remain valid.
+			void reset();
+
+			// Returns stable storage for an event's statistics.
+			EventStatistics* getEventStatistics(const char* eventType);
+
+			// Returns stable storage for a callback's statistics, identifying it by its definition.
+			CallbackStatistics* getCallbackStatistics(const char* eventType, const sol::protected_function& callback);
+
+			// Called once per frame. Counts frames for attribution, and performs any periodic dump.
+			void onFrame();
+
+			// Writes the current statistics to MWSE.log.
+			void dump();
+
+			// Converts a span of time into milliseconds.
+			inline double getMilliseconds(Clock::time_point start, Clock::time_point end) {
+				return std::chrono::duration<double, std::milli>(end - start).count();
+			}
+		}
+
+		// Create all the necessary lua binding for the profiler API.
+		void bindLuaProfiler();
+	}
+}
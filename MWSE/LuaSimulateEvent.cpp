@@ -17,6 +17,11 @@ namespace mwse {
 
 				return eventData;
 			}
+
+			bool SimulateEvent::getEventEnabled() {
+				static const EventCallbacks& callbacks = getEventCallbacks("simulate");
+				return callbacks.hasListeners();
+			}
 		}
 	}
 }
@@ -11,6 +11,9 @@ namespace mwse {
 				SimulateEvent(float delta, double timestamp);
 				sol::table createEventTable();
 
+				// Fast check for any listeners, to avoid creating the event at all.
+				static bool getEventEnabled();
+
 			protected:
 				double m_Timestamp;
 			};
@@ -10,6 +10,26 @@
 namespace mwse {
 	namespace lua {
 		namespace event {
+			static const LazyEventField lazyCasterField("caster", [](void* data) {
+				return makeLuaObject(static_cast<TES3::BaseObject*>(data));
+			});
+
+			static const LazyEventField lazyTargetField("target", [](void* data) {
+				return makeLuaObject(static_cast<TES3::BaseObject*>(data));
+			});
+
+			static const LazyEventField lazySourceField("source", [](void* data) {
+				return makeLuaObject(static_cast<TES3::BaseObject*>(data));
+			});
+
+			static const LazyEventField lazySourceInstanceField("sourceInstance", [](void* data) {
+				return makeLuaObject(static_cast<TES3::BaseObject*>(data));
+			});
+
+			static const LazyEventField lazyEffectInstanceField("effectInstance", [](void* data) {
+				return sol::make_object(LuaManager::getInstance().getState(), static_cast<TES3::MagicEffectInstance*>(data));
+			});
+
 			SpellTickEvent::SpellTickEvent(int effectId, TES3::MagicSourceInstance * sourceInstance, float deltaTime, TES3::MagicEffectInstance * effectInstance, int effectIndex) :
 				GenericEvent("spellTick"),
 				m_EffectId(effectId),
@@ -22,20 +42,20 @@ namespace mwse {
 			}
 
 			sol::table SpellTickEvent::createEventTable() {
-				sol::state& state = LuaManager::getInstance().getState();
-				sol::table eventData = LuaManager::getInstance().createTable();
+				sol::table eventData = createLazyEventTable(9);
 
-				eventData["caster"] = makeLuaObject(m_SourceInstance->caster);
-				eventData["target"] = makeLuaObject(m_EffectInstance->target);
+				setLazyEventField(eventData, lazyCasterField, m_SourceInstance->caster);
+				setLazyEventField(eventData, lazyTargetField, m_EffectInstance->target);
 
 				eventData["effectId"] = m_EffectId;
-				eventData["source"] = makeLuaObject(m_SourceInstance->sourceCombo.source.asGeneric);
-				eventData["sourceInstance"] = makeLuaObject(m_SourceInstance);
+				setLazyEventField(eventData, lazySourceField, m_SourceInstance->sourceCombo.source.asGeneric);
+				setLazyEventField(eventData, lazySourceInstanceField, m_SourceInstance);
 				eventData["deltaTime"] = m_DeltaTime;
 				eventData["effectIndex"] = m_EffectIndex;
-				eventData["effectInstance"] = m_EffectInstance;
+				setLazyEventField(eventData, lazyEffectInstanceField, m_EffectInstance);
 
-				// Get the specific effect on the source.
+				// Get the specific effect on the source. It's copied now, as handlers may keep the payload
+				// around after the source instance is gone.
 				TES3::Effect * effects = m_SourceInstance->sourceCombo.getSourceEffects();
 				if (effects) {
 					eventData["effect"] = effects[m_EffectIndex];
@@ -44,6 +64,11 @@ namespace mwse {
 				return eventData;
 			}
 
+			bool SpellTickEvent::getEventEnabled() {
+				static const EventCallbacks& callbacks = getEventCallbacks("spellTick");
+				return callbacks.hasListeners();
+			}
+
 			sol::object SpellTickEvent::getEventOptions() {
 				sol::state& state = LuaManager::getInstance().getState();
 				sol::table options = LuaManager::getInstance().createTable();
@@ -13,6 +13,9 @@ namespace mwse {
 				sol::table createEventTable();
 				sol::object getEventOptions();
 
+				// Fast check for any listeners, to avoid creating the event at all.
+				static bool getEventEnabled();
+
 			protected:
 				int m_EffectId;
 				TES3::MagicSourceInstance * m_SourceInstance;
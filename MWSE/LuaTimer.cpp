@@ -14,29 +14,77 @@ namespace mwse {
 		// TimeComparer
 		//
 
-		bool TimerComparer::operator()(const std::shared_ptr<Timer>& first, double second) {
-			return first->timing < second;
-		}
-
 		bool TimerComparer::operator()(const std::shared_ptr<Timer>& first, const std::shared_ptr<Timer>& second) {
-			return first->timing < second->timing;
+			if (first->timing != second->timing) {
+				return first->timing < second->timing;
+			}
+			return first->sequence < second->sequence;
 		}
 
-		// Single instance to the comparator used for std::upper_bound.
+		// Single instance to the comparator used for heap ordering.
 		TimerComparer comparer;
 
+		//
+		// TimerAllocator
+		//
+
+		// Recycles the memory used by timers and their shared_ptr control blocks, so steady timer
+		// traffic doesn't hit the heap. Timers are only ever created and released on the main
+		// thread, so the free list is unguarded. The free list is never destroyed, as timers may
+		// still be released while static objects are torn down.
+		template <typename T>
+		struct TimerAllocator {
+			typedef T value_type;
+
+			TimerAllocator() = default;
+			template <typename U> TimerAllocator(const TimerAllocator<U>&) {}
+
+			T* allocate(size_t count) {
+				auto& freeList = getFreeList();
+				if (count != 1 || freeList.empty()) {
+					return static_cast<T*>(::operator new(count * sizeof(T)));
+				}
+
+				void* memory = freeList.back();
+				freeList.pop_back();
+				return static_cast<T*>(memory);
+			}
+
+			void deallocate(T* memory, size_t count) {
+				if (count != 1) {
+					::operator delete(memory);
+					return;
+				}
+
+				getFreeList().push_back(memory);
+			}
+
+			static std::vector<void*>& getFreeList() {
+				static std::vector<void*>* freeList = new std::vector<void*>();
+				return *freeList;
+			}
+		};
+
+		template <typename T, typename U>
+		bool operator==(const TimerAllocator<T>&, const TimerAllocator<U>&) { return true; }
+
+		template <typename T, typename U>
+		bool operator!=(const TimerAllocator<T>&, const TimerAllocator<U>&) { return false; }
+
 		//
 		// TimerController
 		//
 
 		TimerController::TimerController() :
-			m_Clock(0.0)
+			m_Clock(0.0),
+			m_NextSequence(0)
 		{
 
 		}
 
 		TimerController::TimerController(double initialClock) :
-			m_Clock(initialClock)
+			m_Clock(initialClock),
+			m_NextSequence(0)
 		{
 
 		}
@@ -55,41 +103,70 @@ namespace mwse {
 			return m_Clock;
 		}
 
-		std::shared_ptr<Timer> TimerController::createTimer(double duration, sol::protected_function callback, int iterations) {
-			// Validate parameters.
-			if (duration <= 0.0 || callback.get_type() != sol::type::function) {
+		std::shared_ptr<Timer> TimerController::createTimer(double duration, sol::protected_function callback, int iterations, sol::object owner) {
+			auto timer = makeTimer(duration, callback, iterations, owner);
+			if (timer == nullptr) {
 				return nullptr;
 			}
-			else if (iterations < 0) {
-				iterations = 0;
-			}
 
-			// Setup the timer structure.
-			auto timer = std::make_shared<Timer>();
-			timer->controller = this;
-			timer->duration = duration;
-			timer->timing = m_Clock + duration;
-			timer->iterations = iterations;
-			timer->callback = callback;
-
-			// Find the position in the list to add this timer, and add it.
+			// Add it to the active timer heap.
 			insertActiveTimer(timer);
 
 			return timer;
 		}
 
+		std::vector<std::shared_ptr<Timer>> TimerController::createTimers(sol::table timers, sol::object owner) {
+			std::vector<std::shared_ptr<Timer>> results;
+			size_t previousCount = m_ActiveTimers.size();
+
+			// Create every timer first, so invalid parameters don't leave a partial batch behind.
+			size_t count = timers.size();
+			results.reserve(count);
+			for (size_t i = 1; i <= count; i++) {
+				sol::table params = timers[i];
+				double duration = getOptionalParam<double>(params, "duration", 0.0);
+				sol::function callback = getOptionalParam<sol::function>(params, "callback", sol::nil);
+				int iterations = getOptionalParam<int>(params, "iterations", 1);
+				sol::object timerOwner = getOptionalParam<sol::object>(params, "owner", owner);
+
+				auto timer = makeTimer(duration, callback, iterations, timerOwner);
+				if (timer == nullptr) {
+					throw std::exception("Invalid timer parameters given to batch.");
+				}
+				results.push_back(timer);
+			}
+
+			// Then place them all at the back of the heap.
+			m_ActiveTimers.reserve(previousCount + count);
+			for (const auto& timer : results) {
+				timer->sequence = m_NextSequence++;
+				timer->heapIndex = m_ActiveTimers.size();
+				m_ActiveTimers.push_back(timer);
+			}
+
+			// Sift small batches into place. Rebuild the heap outright for large ones.
+			if (count > previousCount) {
+				rebuildActiveTimers();
+			}
+			else {
+				for (size_t i = previousCount; i < m_ActiveTimers.size(); i++) {
+					siftUp(i);
+				}
+			}
+
+			return results;
+		}
+
 		bool TimerController::pauseTimer(std::shared_ptr<Timer> timer) {
 			// Validate timer.
 			if (timer->state != TimerState::Active) {
 				return false;
 			}
 
-			// Remove from the active timer list.
-			auto result = std::find(m_ActiveTimers.begin(), m_ActiveTimers.end(), timer);
-			if (result == m_ActiveTimers.end()) {
+			// Remove from the active timer heap.
+			if (!removeActiveTimer(timer)) {
 				return false;
 			}
-			m_ActiveTimers.erase(result);
 
 			// And add it to the paused list.
 			m_PausedTimers.insert(timer);
@@ -110,7 +187,9 @@ namespace mwse {
 			// Remove from the paused timer list.
 			m_PausedTimers.erase(timer);
 
-			// Add to the active list.
+			// Add to the active heap, converting the time left back into a completion time.
+			timer->state = TimerState::Active;
+			timer->timing = m_Clock + timer->timing;
 			insertActiveTimer(timer);
 
 			return true;
@@ -122,10 +201,11 @@ namespace mwse {
 				return false;
 			}
 
-			// Change timing.
+			// Change timing. It goes behind any other timers completing at the same time.
 			timer->timing = m_Clock + timer->duration;
+			timer->sequence = m_NextSequence++;
 
-			// Move it to the right place in the list.
+			// Move it to the right place in the heap.
 			repositionTimer(timer);
 
 			return true;
@@ -135,14 +215,9 @@ namespace mwse {
 			TimerState previousState = timer->state;
 			timer->state = TimerState::Expired;
 
-			// Remove from the active list.
+			// Remove from the active heap.
 			if (previousState == TimerState::Active) {
-				auto position = std::find(m_ActiveTimers.begin(), m_ActiveTimers.end(), timer);
-				if (position == m_ActiveTimers.end()) {
-					return false;
-				}
-				m_ActiveTimers.erase(position);
-				return true;
+				return removeActiveTimer(timer);
 			}
 
 			// Remove from the paused timer list.
@@ -153,6 +228,57 @@ namespace mwse {
 			return false;
 		}
 
+		// Owners are compared using raw equality, so metamethods can't be invoked mid-sweep.
+		static bool isTimerOwner(const std::shared_ptr<Timer>& timer, const sol::object& owner) {
+			if (timer->owner == sol::nil) {
+				return false;
+			}
+
+			// Push both onto the same stack, in case either reference came from a coroutine.
+			lua_State* L = owner.lua_state();
+			timer->owner.push(L);
+			owner.push(L);
+			bool result = lua_rawequal(L, -1, -2) != 0;
+			lua_pop(L, 2);
+			return result;
+		}
+
+		int TimerController::cancelTimers(sol::object owner) {
+			if (owner == sol::nil) {
+				return 0;
+			}
+
+			int cancelled = 0;
+
+			// Compact the active heap, dropping owned timers, then restore heap order once.
+			auto activeEnd = std::remove_if(m_ActiveTimers.begin(), m_ActiveTimers.end(), [&](const std::shared_ptr<Timer>& timer) {
+				if (isTimerOwner(timer, owner)) {
+					timer->state = TimerState::Expired;
+					cancelled++;
+					return true;
+				}
+				return false;
+			});
+			if (activeEnd != m_ActiveTimers.end()) {
+				m_ActiveTimers.erase(activeEnd, m_ActiveTimers.end());
+				rebuildActiveTimers();
+			}
+
+			// Remove from the paused timer list.
+			for (auto itt = m_PausedTimers.begin(); itt != m_PausedTimers.end();) {
+				if (isTimerOwner(*itt, owner)) {
+					(*itt)->state = TimerState::Expired;
+					itt = m_PausedTimers.erase(itt);
+					cancelled++;
+				}
+				else {
+					itt++;
+				}
+			}
+
+			return cancelled;
+		}
+
 		void TimerController::clearTimers() {
 			// Mark all timers as expired.
 			for (auto itt = m_ActiveTimers.begin(); itt != m_ActiveTimers.end(); itt++) {
@@ -164,17 +290,48 @@ namespace mwse {
 			m_PausedTimers.clear();
 		}
 
+		// Callbacks that declare no parameters can't see the data table, so it doesn't need to be built for them.
+		// Only LuaJIT's debug.getinfo reports parameter counts; its C API does not.
+		static bool getCallbackTakesData(Timer& timer) {
+			const void* callback = timer.callback.pointer();
+			if (timer.checkedCallback == callback) {
+				return timer.callbackTakesData;
+			}
+
+			timer.checkedCallback = callback;
+			timer.callbackTakesData = true;
+
+			sol::state& state = LuaManager::getInstance().getState();
+			sol::protected_function getInfo = state["debug"]["getinfo"];
+			if (getInfo.get_type() != sol::type::function) {
+				return true;
+			}
+
+			sol::protected_function_result result = getInfo(timer.callback, "u");
+			if (result.valid() && result.get_type() == sol::type::table) {
+				sol::table info = result;
+				timer.callbackTakesData = info.get_or("nparams", 1) != 0 || info.get_or("isvararg", true);
+			}
+
+			return timer.callbackTakesData;
+		}
+
+		static sol::table createCallbackData(const std::shared_ptr<Timer>& timer) {
+			// Callbacks may keep hold of the data, so it can't be reused.
+			sol::table data = LuaManager::getInstance().createTable(0, 1);
+			data["timer"] = timer;
+			return data;
+		}
+
 		void TimerController::update() {
 			// Keep looking at the front timer until it hasn't expired.
-			std::shared_ptr<Timer> timer = nullptr;
-			while (!m_ActiveTimers.empty() && (timer = m_ActiveTimers.front()) && timer->timing <= m_Clock) {
-				// Build data to send to the callback.
-				sol::table data = LuaManager::getInstance().createTable();
-				data["timer"] = timer;
+			while (!m_ActiveTimers.empty() && m_ActiveTimers.front()->timing <= m_Clock) {
+				std::shared_ptr<Timer> timer = m_ActiveTimers.front();
 
 				// Invoke the callback.
 				sol::protected_function callback = timer->callback;
-				sol::protected_function_result result = callback(data);
+				sol::protected_function_result result = getCallbackTakesData(*timer) ? callback(createCallbackData(timer)) : callback();
+
 				if (!result.valid()) {
 					sol::error error = result;
 					log::getLog() << "Lua error encountered in timer callback:" << std::endl << error.what() << std::endl;
@@ -184,6 +341,11 @@ namespace mwse {
 					continue;
 				}
 
+				// The callback may have paused, cancelled, or reset the timer itself.
+				if (timer->state != TimerState::Active) {
+					continue;
+				}
+
 				// Decrement iterations if the timer uses them.
 				if (timer->iterations > 0) {
 					timer->iterations--;
@@ -195,27 +357,122 @@ namespace mwse {
 					}
 				}
 
-				// Update timer and reposition it in the vector.
+				// Update timer and reposition it in the heap.
 				timer->timing += timer->duration;
+				timer->sequence = m_NextSequence++;
 				repositionTimer(timer);
 			}
 		}
 
-		std::vector<std::shared_ptr<Timer>>::iterator TimerController::insertActiveTimer(std::shared_ptr<Timer> timer) {
-			auto position = std::upper_bound(m_ActiveTimers.begin(), m_ActiveTimers.end(), timer, comparer);
-			return m_ActiveTimers.insert(position, timer);
+		std::shared_ptr<Timer> TimerController::makeTimer(double duration, sol::protected_function callback, int iterations, sol::object owner) {
+			// Validate parameters.
+			if (duration <= 0.0 || callback.get_type() != sol::type::function) {
+				return nullptr;
+			}
+			else if (iterations < 0) {
+				iterations = 0;
+			}
+
+			// Setup the timer structure.
+			auto timer = std::allocate_shared<Timer>(TimerAllocator<Timer>());
+			timer->controller = this;
+			timer->state = TimerState::Active;
+			timer->duration = duration;
+			timer->timing = m_Clock + duration;
+			timer->iterations = iterations;
+			timer->callback = callback;
+			timer->callbackTakesData = true;
+			timer->checkedCallback = nullptr;
+			timer->owner = owner;
+
+			return timer;
+		}
+
+		void TimerController::insertActiveTimer(std::shared_ptr<Timer> timer) {
+			timer->sequence = m_NextSequence++;
+			timer->heapIndex = m_ActiveTimers.size();
+			m_ActiveTimers.push_back(timer);
+			siftUp(timer->heapIndex);
 		}
 
-		void TimerController::repositionTimer(std::shared_ptr<Timer> timer) {
-			// Remove from current position.
-			auto position = std::find(m_ActiveTimers.begin(), m_ActiveTimers.end(), timer);
-			if (position == m_ActiveTimers.end()) {
+		bool TimerController::removeActiveTimer(const std::shared_ptr<Timer>& timer) {
+			// Make sure the handle actually points to this timer.
+			size_t index = timer->heapIndex;
+			if (index >= m_ActiveTimers.size() || m_ActiveTimers[index] != timer) {
+				return false;
+			}
+
+			// Move the last timer into the vacated slot, then restore the heap around it.
+			std::shared_ptr<Timer> last = m_ActiveTimers.back();
+			m_ActiveTimers.pop_back();
+			if (index < m_ActiveTimers.size()) {
+				placeActiveTimer(index, last);
+				repositionTimer(last);
+			}
+
+			return true;
+		}
+
+		void TimerController::repositionTimer(const std::shared_ptr<Timer>& timer) {
+			size_t index = timer->heapIndex;
+			if (index >= m_ActiveTimers.size() || m_ActiveTimers[index] != timer) {
 				return;
 			}
-			m_ActiveTimers.erase(position);
 
-			// Then insert it back in.
-			insertActiveTimer(timer);
+			if (index > 0 && comparer(timer, m_ActiveTimers[(index - 1) / 2])) {
+				siftUp(index);
+			}
+			else {
+				siftDown(index);
+			}
+		}
+
+		void TimerController::siftUp(size_t index) {
+			std::shared_ptr<Timer> timer = m_ActiveTimers[index];
+			while (index > 0) {
+				size_t parent = (index - 1) / 2;
+				if (!comparer(timer, m_ActiveTimers[parent])) {
+					break;
+				}
+				placeActiveTimer(index, m_ActiveTimers[parent]);
+				index = parent;
+			}
+			placeActiveTimer(index, timer);
+		}
+
+		void TimerController::siftDown(size_t index) {
+			std::shared_ptr<Timer> timer = m_ActiveTimers[index];
+			size_t count = m_ActiveTimers.size();
+			while (true) {
+				size_t child = index * 2 + 1;
+				if (child >= count) {
+					break;
+				}
+				if (child + 1 < count && comparer(m_ActiveTimers[child + 1], m_ActiveTimers[child])) {
+					child++;
+				}
+				if (!comparer(m_ActiveTimers[child], timer)) {
+					break;
+				}
+				placeActiveTimer(index, m_ActiveTimers[child]);
+				index = child;
+			}
+			placeActiveTimer(index, timer);
+		}
+
+		void TimerController::placeActiveTimer(size_t index, std::shared_ptr<Timer> timer) {
+			timer->heapIndex = index;
+			m_ActiveTimers[index] = std::move(timer);
+		}
+
+		void TimerController::rebuildActiveTimers() {
+			for (size_t i = 0; i < m_ActiveTimers.size(); i++) {
+				m_ActiveTimers[i]->heapIndex = i;
+			}
+
+			for (size_t i = m_ActiveTimers.size() / 2; i > 0; i--) {
+				siftDown(i - 1);
+			}
 		}
 
 		//
@@ -228,6 +485,7 @@ namespace mwse {
 			double duration = getOptionalParam<double>(params, "duration", 0.0);
 			sol::function callback = getOptionalParam<sol::function>(params, "callback", sol::nil);
 			int iterations = getOptionalParam<int>(params, "iterations", 1);
+			sol::object owner = getOptionalParam<sol::object>(params, "owner", sol::nil);
 
 			// Allow infinite repeat.
 			if (iterations <= 0) {
@@ -235,7 +493,57 @@ namespace mwse {
 			}
 
 			// Create the timer.
-			return controller->createTimer(duration, callback, iterations);
+			return controller->createTimer(duration, callback, iterations, owner);
+		}
+
+		// Create many timers given a controller and a table of parameters.
+		sol::table startTimerBatch(TimerController* controller, sol::table params) {
+			sol::optional<sol::table> timers = params["timers"];
+			if (!timers) {
+				throw std::exception("Batch parameters must contain a timers array.");
+			}
+
+			sol::object owner = getOptionalParam<sol::object>(params, "owner", sol::nil);
+			auto created = controller->createTimers(timers.value(), owner);
+
+			sol::table results = LuaManager::getInstance().getState().create_table(created.size(), 0);
+			for (size_t i = 0; i < created.size(); i++) {
+				results[i + 1] = created[i];
+			}
+			return results;
+		}
+
+		// Create many timers, as above, but get the controller from params.type.
+		sol::table startTimerBatchAmbiguous(sol::table params) {
+			unsigned int type = getOptionalParam<unsigned int>(params, "type", unsigned int(TimerType::SimulationTime));
+			std::shared_ptr<TimerController> controller = LuaManager::getInstance().getTimerController(static_cast<TimerType>(type));
+			if (controller == nullptr) {
+				throw std::exception("Invalid timer type given to batch.");
+			}
+
+			return startTimerBatch(controller.get(), params);
+		}
+
+		// Cancel all timers with a given owner, either from one controller or from all of them.
+		int cancelAllTimers(sol::object owner, sol::optional<int> type) {
+			if (owner == sol::nil) {
+				throw std::exception("An owner must be provided.");
+			}
+
+			LuaManager& luaManager = LuaManager::getInstance();
+			if (type) {
+				std::shared_ptr<TimerController> controller = luaManager.getTimerController(static_cast<TimerType>(type.value()));
+				if (controller == nullptr) {
+					return 0;
+				}
+				return controller->cancelTimers(owner);
+			}
+
+			int cancelled = 0;
+			for (TimerType timerType : { TimerType::RealTime, TimerType::SimulationTime, TimerType::GameTime }) {
+				cancelled += luaManager.getTimerController(timerType)->cancelTimers(owner);
+			}
+			return cancelled;
 		}
 
 		// Create a timer, as above, but get the controller from params.type.
@@ -336,6 +644,12 @@ namespace mwse {
 				usertypeDefinition.set("create", [](TimerController& self, sol::table params) {
 					return startTimer(&self, params);
 				});
+				usertypeDefinition.set("createBatch", [](TimerController& self, sol::table params) {
+					return startTimerBatch(&self, params);
+				});
+				usertypeDefinition.set("cancelAll", [](TimerController& self, sol::object owner) {
+					return self.cancelTimers(owner);
+				});
 
 				// Finish up our usertype.
 				state.set_usertype("mwseTimerController", usertypeDefinition);
@@ -353,6 +667,7 @@ namespace mwse {
 				usertypeDefinition.set("state", sol::readonly_property(&Timer::state));
 				usertypeDefinition.set("timing", sol::readonly_property(&Timer::timing));
 				usertypeDefinition.set("callback", sol::readonly_property(&Timer::callback));
+				usertypeDefinition.set("owner", sol::readonly_property(&Timer::owner));
 				usertypeDefinition.set("timeLeft", sol::readonly_property([](Timer& self) -> sol::object {
 					sol::state& state = LuaManager::getInstance().getState();
 					if (self.state == TimerState::Active) {
@@ -405,6 +720,10 @@ namespace mwse {
 			// Bind the legacy and new start functions.
 			state["timer"]["start"] = sol::overload(&startTimerAmbiguous, &startTimerLegacySimulation, &startTimerLegacySimulationWithIterations);
 
+			// Bulk timer creation and cancellation.
+			state["timer"]["startBatch"] = &startTimerBatchAmbiguous;
+			state["timer"]["cancelAll"] = &cancelAllTimers;
+
 			// Legacy support for frame timers.
 			state["timer"]["frame"] = LuaManager::getInstance().createTable();
 			state["timer"]["frame"]["start"] = sol::overload(&startTimerLegacyReal, &startTimerLegacyRealWithIterations);
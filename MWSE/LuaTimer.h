@@ -15,9 +15,8 @@ namespace mwse {
 			Expired
 		};
 
-		// Comparing structure for use with std::upper_bound.
+		// Ordering for the active timer heap. Timers completing at the same time fire in the order they were scheduled.
 		struct TimerComparer {
-			bool operator() (const std::shared_ptr<Timer>& first, double second);
 			bool operator() (const std::shared_ptr<Timer>& first, const std::shared_ptr<Timer>& second);
 		};
 
@@ -40,7 +39,10 @@ namespace mwse {
 			double getClock();
 
 			// Create a new timer with fixed data.
-			std::shared_ptr<Timer> createTimer(double duration, sol::protected_function callback, int iterations = 1);
+			std::shared_ptr<Timer> createTimer(double duration, sol::protected_function callback, int iterations = 1, sol::object owner = sol::nil);
+
+			// Create many timers from an array of timer parameters, rebuilding the active timer heap once.
+			std::vector<std::shared_ptr<Timer>> createTimers(sol::table timers, sol::object owner = sol::nil);
 
 			// Move a timer from the active list to the inactive list, and mark it paused.
 			bool pauseTimer(std::shared_ptr<Timer> timer);
@@ -54,22 +56,42 @@ namespace mwse {
 			// Cancel a timer, disconnecting it from this controller.
 			bool cancelTimer(std::shared_ptr<Timer> timer);
 
+			// Cancel every timer with the given owner in a single pass. Returns the number of timers cancelled.
+			int cancelTimers(sol::object owner);
+
 			void clearTimers();
 
 		private:
 			// Runs through the active timer list. Triggers and expires/iterates completed timers.
 			void update();
 
-			// Places a timer into it the active timer list, based on its completion timing.
-			std::vector<std::shared_ptr<Timer>>::iterator insertActiveTimer(std::shared_ptr<Timer> timer);
+			// Sets up a new timer without activating it. Returns nullptr if the parameters are invalid.
+			std::shared_ptr<Timer> makeTimer(double duration, sol::protected_function callback, int iterations, sol::object owner);
+
+			// Places a timer into the active timer heap, based on its completion timing.
+			void insertActiveTimer(std::shared_ptr<Timer> timer);
+
+			// Removes a timer from the active timer heap.
+			bool removeActiveTimer(const std::shared_ptr<Timer>& timer);
+
+			// Restores heap order after an active timer's timing has changed.
+			void repositionTimer(const std::shared_ptr<Timer>& timer);
+
+			// Heap maintenance. These keep each timer's heapIndex up to date.
+			void siftUp(size_t index);
+			void siftDown(size_t index);
+			void placeActiveTimer(size_t index, std::shared_ptr<Timer> timer);
 
-			// Removes an active timer, then inserts it back into the active timer list based on its timing.
-			void repositionTimer(std::shared_ptr<Timer> timer);
+			// Restores heap order for the entire active timer list in linear time.
+			void rebuildActiveTimers();
 
 			// The current internal clock to compare timers against.
 			double m_Clock;
 
-			// A list of active timers, sorted by their completion time.
+			// Incremented for each activated timer, to keep ordering stable for timers with equal timing.
+			unsigned long long m_NextSequence;
+
+			// A binary min-heap of active timers, ordered by their completion time.
 			std::vector<std::shared_ptr<Timer>> m_ActiveTimers;
 
 			// An unordered collection of paused timers.
@@ -95,6 +117,20 @@ namespace mwse {
 
 			// Callback for timer completion.
 			sol::protected_function callback;
+
+			// Whether the callback declares any parameters, and the callback that was checked. The
+			// callback can be replaced from lua, so this is checked again if it changes.
+			bool callbackTakesData;
+			const void* checkedCallback;
+
+			// Optional value used to cancel groups of timers together.
+			sol::object owner;
+
+			// The timer's position in its controller's active timer heap, while active.
+			size_t heapIndex;
+
+			// Order of activation, used to break ties between timers with equal timing.
+			unsigned long long sequence;
 		};
 
 		// Create all the necessary lua binding for the timer API and the above data types.
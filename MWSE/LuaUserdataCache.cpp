@@ -0,0 +1,128 @@
+#include "LuaUserdataCache.h"
+
+namespace mwse {
+	namespace lua {
+		// Initial number of slots. Must be a power of two.
+		const size_t UserdataCacheInitialSize = 1024;
+
+		UserdataCache::UserdataCache() :
+			m_Entries(UserdataCacheInitialSize),
+			m_Count(0)
+		{
+
+		}
+
+		size_t UserdataCache::getIdealSlot(const void* key) const {
+			// Addresses are aligned and clustered, so fully mix them before taking the low bits. This is
+			// murmur3's 32-bit finalizer.
+			unsigned int hash = static_cast<unsigned int>(reinterpret_cast<size_t>(key));
+			hash ^= hash >> 16;
+			hash *= 0x85EBCA6Bu;
+			hash ^= hash >> 13;
+			hash *= 0xC2B2AE35u;
+			hash ^= hash >> 16;
+			return hash & (m_Entries.size() - 1);
+		}
+
+		const sol::object* UserdataCache::find(const void* key) const {
+			if (key == nullptr) {
+				return nullptr;
+			}
+
+			size_t mask = m_Entries.size() - 1;
+			for (size_t slot = getIdealSlot(key); m_Entries[slot].key != nullptr; slot = (slot + 1) & mask) {
+				if (m_Entries[slot].key == key) {
+					return &m_Entries[slot].value;
+				}
+			}
+
+			return nullptr;
+		}
+
+		void UserdataCache::insert(const void* key, sol::object value) {
+			if (key == nullptr) {
+				return;
+			}
+
+			// Keep the load factor at or below one half.
+			if ((m_Count + 1) * 2 > m_Entries.size()) {
+				grow();
+			}
+
+			size_t mask = m_Entries.size() - 1;
+			size_t slot = getIdealSlot(key);
+			while (m_Entries[slot].key != nullptr) {
+				if (m_Entries[slot].key == key) {
+					m_Entries[slot].value = std::move(value);
+					return;
+				}
+				slot = (slot + 1) & mask;
+			}
+
+			m_Entries[slot].key = key;
+			m_Entries[slot].value = std::move(value);
+			m_Count++;
+		}
+
+		sol::object UserdataCache::remove(const void* key) {
+			if (key == nullptr || m_Count == 0) {
+				return sol::nil;
+			}
+
+			size_t mask = m_Entries.size() - 1;
+			size_t slot = getIdealSlot(key);
+			while (m_Entries[slot].key != key) {
+				if (m_Entries[slot].key == nullptr) {
+					return sol::nil;
+				}
+				slot = (slot + 1) & mask;
+			}
+
+			sol::object removed = std::move(m_Entries[slot].value);
+			m_Entries[slot].key = nullptr;
+			m_Entries[slot].value = sol::nil;
+			m_Count--;
+
+			// Shift any following entries back, if doing so brings them closer to their ideal slot.
+			size_t hole = slot;
+			for (size_t next = (slot + 1) & mask; m_Entries[next].key != nullptr; next = (next + 1) & mask) {
+				size_t ideal = getIdealSlot(m_Entries[next].key);
+				if (((next - ideal) & mask) >= ((next - hole) & mask)) {
+					m_Entries[hole].key = m_Entries[next].key;
+					m_Entries[hole].value = std::move(m_Entries[next].value);
+					m_Entries[next].key = nullptr;
+					m_Entries[next].value = sol::nil;
+					hole = next;
+				}
+			}
+
+			return removed;
+		}
+
+		void UserdataCache::clear() {
+			m_Entries.clear();
+			m_Entries.resize(UserdataCacheInitialSize);
+			m_Count = 0;
+		}
+
+		bool UserdataCache::empty() const {
+			return m_Count == 0;
+		}
+
+		size_t UserdataCache::size() const {
+			return m_Count;
+		}
+
+		void UserdataCache::grow() {
+			std::vector<Entry> previous(m_Entries.size() * 2);
+			previous.swap(m_Entries);
+			m_Count = 0;
+
+			for (auto& entry : previous) {
+				if (entry.key != nullptr) {
+					insert(entry.key, std::move(entry.value));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include "sol.hpp"
+
+namespace mwse {
+	namespace lua {
+		// An open-addressing hash map from game object pointers to their lua userdata. Uses linear
+		// probing with backward shift deletion, so lookups never have to step over tombstones.
+		// Not thread safe. All access must happen on the main thread.
+		class UserdataCache {
+		public:
+			UserdataCache();
+
+			// Returns the cached userdata for the given object, or nullptr if it isn't cached.
+			const sol::object* find(const void* key) const;
+
+			// Adds or replaces the userdata for the given object.
+			void insert(const void* key, sol::object value);
+
+			// Removes the userdata for the given object, returning it. Returns nil if it wasn't cached.
+			sol::object remove(const void* key);
+
+			void clear();
+
+			bool empty() const;
+			size_t size() const;
+
+		private:
+			struct Entry {
+				const void* key = nullptr;
+				sol::object value;
+			};
+
+			size_t getIdealSlot(const void* key) const;
+			void grow();
+
+			std::vector<Entry> m_Entries;
+			size_t m_Count;
+		};
+	}
+}
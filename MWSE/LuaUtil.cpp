@@ -254,25 +254,32 @@ namespace mwse {
 			return value;
 		}
 
+		bool getVectorFromLua(sol::object value, TES3::Vector3& out) {
+			// Were we given a real vector?
+			if (value.is<TES3::Vector3*>()) {
+				out = *value.as<TES3::Vector3*>();
+				return true;
+			}
+
+			// Were we given a table?
+			else if (value.get_type() == sol::type::table) {
+				sol::table valueTable = value.as<sol::table>();
+				out.x = valueTable[1];
+				out.y = valueTable[2];
+				out.z = valueTable[3];
+				return true;
+			}
+
+			return false;
+		}
+
 		sol::optional<TES3::Vector3> getOptionalParamVector3(sol::optional<sol::table> maybeParams, const char* key) {
 			if (maybeParams) {
 				sol::table params = maybeParams.value();
 				sol::object maybeValue = params[key];
-				if (maybeValue.valid()) {
-					// Were we given a real vector?
-					if (maybeValue.is<TES3::Vector3*>()) {
-						return *maybeValue.as<TES3::Vector3*>();
-					}
-
-					// Were we given a table?
-					else if (maybeValue.get_type() == sol::type::table) {
-						sol::table value = maybeValue.as<sol::table>();
-						TES3::Vector3* result = tes3::malloc<TES3::Vector3>();
-						result->x = value[1];
-						result->y = value[2];
-						result->z = value[3];
-						return TES3::Vector3(value[1], value[2], value[3]);
-					}
+				TES3::Vector3 result;
+				if (maybeValue.valid() && getVectorFromLua(maybeValue, result)) {
+					return result;
 				}
 			}
 
@@ -62,6 +62,9 @@ namespace mwse {
 
 		void setVectorFromLua(TES3::Vector3*, sol::stack_object);
 
+		// Reads a vector or a table of three numbers. Returns false if the value is neither.
+		bool getVectorFromLua(sol::object value, TES3::Vector3& out);
+
 		sol::object makeLuaObject(TES3::BaseObject* object);
 		sol::object makeLuaObject(TES3::MobileObject* object);
 		sol::object makeLuaObject(TES3::Weather* weather);
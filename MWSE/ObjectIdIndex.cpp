@@ -0,0 +1,343 @@
+#include "ObjectIdIndex.h"
+
+#include "TES3Collections.h"
+#include "TES3DataHandler.h"
+#include "TES3Reference.h"
+
+#include <Windows.h>
+
+#include <cstring>
+
+namespace mwse {
+	namespace tes3 {
+		//
+		// ObjectIdTable
+		//
+
+		// Initial number of slots. Must be a power of two.
+		const size_t ObjectIdTableInitialSize = 256;
+
+		// Folds ASCII uppercase to lowercase. IDs in the game data are never compared with locale rules.
+		inline char foldCase(char c) {
+			return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+		}
+
+		ObjectIdTable::ObjectIdTable() :
+			m_Entries(ObjectIdTableInitialSize),
+			m_Count(0)
+		{
+
+		}
+
+		unsigned int ObjectIdTable::getHash(const char* id) {
+			// FNV-1a over the case folded ID.
+			unsigned int hash = 2166136261u;
+			for (; *id; id++) {
+				hash ^= (unsigned char)foldCase(*id);
+				hash *= 16777619u;
+			}
+
+			// Zero is reserved for empty slots.
+			return hash ? hash : 1;
+		}
+
+		bool ObjectIdTable::matches(const std::string& key, const char* id) {
+			size_t length = key.length();
+			for (size_t i = 0; i < length; i++) {
+				if (key[i] != foldCase(id[i])) {
+					return false;
+				}
+			}
+			return id[length] == '\0';
+		}
+
+		void* ObjectIdTable::find(const char* id) const {
+			if (id == nullptr || m_Count == 0) {
+				return nullptr;
+			}
+
+			unsigned int hash = getHash(id);
+			size_t mask = m_Entries.size() - 1;
+			for (size_t slot = hash & mask; m_Entries[slot].hash != 0; slot = (slot + 1) & mask) {
+				if (m_Entries[slot].hash == hash && matches(m_Entries[slot].key, id)) {
+					return m_Entries[slot].value;
+				}
+			}
+
+			return nullptr;
+		}
+
+		void ObjectIdTable::insert(const char* id, void* value) {
+			if (id == nullptr || value == nullptr) {
+				return;
+			}
+
+			// Keep the load factor at or below one half.
+			if ((m_Count + 1) * 2 > m_Entries.size()) {
+				grow();
+			}
+
+			unsigned int hash = getHash(id);
+			size_t mask = m_Entries.size() - 1;
+			size_t slot = hash & mask;
+			while (m_Entries[slot].hash != 0) {
+				if (m_Entries[slot].hash == hash && matches(m_Entries[slot].key, id)) {
+					// Replace the existing entry, forgetting how the old value was keyed.
+					auto range = m_KeysByValue.equal_range(m_Entries[slot].value);
+					for (auto itt = range.first; itt != range.second; itt++) {
+						if (itt->second == m_Entries[slot].key) {
+							m_KeysByValue.erase(itt);
+							break;
+						}
+					}
+
+					m_Entries[slot].value = value;
+					m_KeysByValue.emplace(value, m_Entries[slot].key);
+					return;
+				}
+				slot = (slot + 1) & mask;
+			}
+
+			Entry& entry = m_Entries[slot];
+			entry.key.resize(strlen(id));
+			for (size_t i = 0; i < entry.key.length(); i++) {
+				entry.key[i] = foldCase(id[i]);
+			}
+			entry.hash = hash;
+			entry.value = value;
+			m_Count++;
+
+			m_KeysByValue.emplace(value, entry.key);
+		}
+
+		bool ObjectIdTable::remove(const void* value) {
+			auto range = m_KeysByValue.equal_range(value);
+			if (range.first == range.second) {
+				return false;
+			}
+
+			for (auto itt = range.first; itt != range.second; itt++) {
+				removeKey(itt->second, getHash(itt->second.c_str()));
+			}
+			m_KeysByValue.erase(range.first, range.second);
+
+			return true;
+		}
+
+		bool ObjectIdTable::removeKey(const std::string& key, unsigned int hash) {
+			size_t mask = m_Entries.size() - 1;
+			size_t slot = hash & mask;
+			while (m_Entries[slot].hash != hash || m_Entries[slot].key != key) {
+				if (m_Entries[slot].hash == 0) {
+					return false;
+				}
+				slot = (slot + 1) & mask;
+			}
+
+			m_Entries[slot] = Entry();
+			m_Count--;
+
+			// Shift any following entries back, if doing so brings them closer to their ideal slot.
+			size_t hole = slot;
+			for (size_t next = (slot + 1) & mask; m_Entries[next].hash != 0; next = (next + 1) & mask) {
+				size_t ideal = m_Entries[next].hash & mask;
+				if (((next - ideal) & mask) >= ((next - hole) & mask)) {
+					m_Entries[hole] = std::move(m_Entries[next]);
+					m_Entries[next] = Entry();
+					hole = next;
+				}
+			}
+
+			return true;
+		}
+
+		void ObjectIdTable::clear() {
+			m_Entries.clear();
+			m_Entries.resize(ObjectIdTableInitialSize);
+			m_Count = 0;
+			m_KeysByValue.clear();
+		}
+
+		void ObjectIdTable::grow() {
+			std::vector<Entry> previous(m_Entries.size() * 2);
+			previous.swap(m_Entries);
+
+			// Entries keep their hashes, so they can be placed directly without rehashing the keys.
+			size_t mask = m_Entries.size() - 1;
+			for (auto& entry : previous) {
+				if (entry.hash != 0) {
+					size_t slot = entry.hash & mask;
+					while (m_Entries[slot].hash != 0) {
+						slot = (slot + 1) & mask;
+					}
+					m_Entries[slot] = std::move(entry);
+				}
+			}
+		}
+
+		//
+		// ObjectIdIndex
+		//
+
+		ObjectIdIndex ObjectIdIndex::singleton;
+
+		TES3::BaseObject* ObjectIdIndex::findObject(const char* id) {
+			processPendingRemovals();
+			return static_cast<TES3::BaseObject*>(m_Objects.find(id));
+		}
+
+		TES3::Reference* ObjectIdIndex::findActorClone(const char* baseId) {
+			processPendingRemovals();
+			auto reference = static_cast<TES3::Reference*>(m_ActorClones.find(baseId));
+
+			// A deleted reference is kept around until it's destroyed. Let the engine find another clone.
+			if (reference && (reference->objectFlags & TES3::ObjectFlag::Delete)) {
+				m_ActorClones.remove(reference);
+				return nullptr;
+			}
+
+			return reference;
+		}
+
+		TES3::GlobalVariable* ObjectIdIndex::findGlobal(const char* id) {
+			processPendingRemovals();
+			return static_cast<TES3::GlobalVariable*>(m_Globals.find(id));
+		}
+
+		void ObjectIdIndex::cacheObject(const char* id, TES3::BaseObject* object) {
+			processPendingRemovals();
+			m_Objects.insert(id, object);
+		}
+
+		void ObjectIdIndex::cacheActorClone(const char* baseId, TES3::Reference* reference) {
+			processPendingRemovals();
+			m_ActorClones.insert(baseId, reference);
+		}
+
+		void ObjectIdIndex::cacheGlobal(const char* id, TES3::GlobalVariable* global) {
+			processPendingRemovals();
+			m_Globals.insert(id, global);
+		}
+
+		char ObjectIdIndex::findLocalVariable(const TES3::Script* script, const char* name, unsigned int* out_index) {
+			processPendingRemovals();
+			auto variables = m_LocalVariables.find(script);
+			if (variables == m_LocalVariables.end()) {
+				return 0;
+			}
+
+			// The type is never zero, so packed values are never null.
+			size_t packed = reinterpret_cast<size_t>(variables->second->find(name));
+			if (packed == 0) {
+				return 0;
+			}
+
+			*out_index = packed >> 8;
+			return char(packed & 0xFF);
+		}
+
+		void ObjectIdIndex::cacheLocalVariable(const TES3::Script* script, const char* name, char type, unsigned int index) {
+			if (type == 0) {
+				return;
+			}
+
+			processPendingRemovals();
+			auto& variables = m_LocalVariables[script];
+			if (variables == nullptr) {
+				variables = std::make_unique<ObjectIdTable>();
+			}
+			variables->insert(name, reinterpret_cast<void*>((size_t(index) << 8) | (unsigned char)type));
+		}
+
+		TES3::SoundGenerator* ObjectIdIndex::getSoundGenerator(const char* creatureId, TES3::SoundType type) {
+			size_t typeIndex = size_t(type);
+			if (creatureId == nullptr || typeIndex >= 8) {
+				return nullptr;
+			}
+
+			SoundGeneratorSet& set = m_SoundGenerators[creatureId];
+			if (set.searched[typeIndex]) {
+				return set.generators[typeIndex];
+			}
+
+			// Find the first generator whose name starts with the creature ID.
+			TES3::SoundGenerator* result = nullptr;
+			size_t creatureIdLength = strlen(creatureId);
+			auto soundGenerators = TES3::DataHandler::get()->nonDynamicData->soundGenerators;
+			for (auto itt = soundGenerators->head; itt != NULL; itt = itt->next) {
+				if (itt->data->soundType != type) {
+					continue;
+				}
+
+				if (strncmp(creatureId, itt->data->name, creatureIdLength) == 0) {
+					result = itt->data;
+					break;
+				}
+			}
+
+			set.generators[typeIndex] = result;
+			set.searched[typeIndex] = true;
+
+			return result;
+		}
+
+		static bool isMainThread() {
+			auto dataHandler = TES3::DataHandler::get();
+			return dataHandler == nullptr || GetCurrentThreadId() == dataHandler->mainThreadID;
+		}
+
+		void ObjectIdIndex::onObjectRemoved(const void* object) {
+			if (!isMainThread()) {
+				if (m_PendingRemovalsOverflowed || !m_PendingRemovals.tryPush(object)) {
+					std::lock_guard<std::mutex> lock(m_PendingRemovalsOverflowMutex);
+					m_PendingRemovalsOverflow.push_back(object);
+					m_PendingRemovalsOverflowed = true;
+				}
+				return;
+			}
+
+			processPendingRemovals();
+			removeObject(object);
+		}
+
+		void ObjectIdIndex::removeObject(const void* object) {
+			m_Objects.remove(object);
+			m_ActorClones.remove(object);
+			m_Globals.remove(object);
+			m_LocalVariables.erase(static_cast<const TES3::Script*>(object));
+		}
+
+		void ObjectIdIndex::processPendingRemovals() {
+			if (m_PendingRemovals.empty() && !m_PendingRemovalsOverflowed) {
+				return;
+			}
+
+			const void* object = nullptr;
+			while (m_PendingRemovals.tryPop(object)) {
+				removeObject(object);
+			}
+
+			if (m_PendingRemovalsOverflowed) {
+				std::vector<const void*> overflow;
+				{
+					std::lock_guard<std::mutex> lock(m_PendingRemovalsOverflowMutex);
+					overflow.swap(m_PendingRemovalsOverflow);
+					m_PendingRemovalsOverflowed = false;
+				}
+
+				for (const void* overflowObject : overflow) {
+					removeObject(overflowObject);
+				}
+			}
+		}
+
+		void ObjectIdIndex::clear() {
+			processPendingRemovals();
+			m_Objects.clear();
+			m_ActorClones.clear();
+			m_SoundGenerators.clear();
+			m_Globals.clear();
+			m_LocalVariables.clear();
+		}
+	}
+}
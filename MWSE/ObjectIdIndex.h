@@ -0,0 +1,120 @@
+#pragma once
+
+#include "TES3Defines.h"
+
+#include "TES3SoundGenerator.h"
+
+#include "LockFreeQueue.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mwse {
+	namespace tes3 {
+		// An open-addressing hash map from object IDs to pointers. IDs are compared case-insensitively,
+		// and hashed without making a lowercase copy of the searched ID. Uses linear probing with
+		// backward shift deletion, like the lua userdata cache.
+		class ObjectIdTable {
+		public:
+			ObjectIdTable();
+
+			void* find(const char* id) const;
+			void insert(const char* id, void* value);
+
+			// Removes every entry that points to the given value. Returns true if anything was removed.
+			bool remove(const void* value);
+
+			void clear();
+
+		private:
+			struct Entry {
+				std::string key;
+				unsigned int hash = 0;
+				void* value = nullptr;
+			};
+
+			static unsigned int getHash(const char* id);
+			static bool matches(const std::string& key, const char* id);
+
+			bool removeKey(const std::string& key, unsigned int hash);
+			void grow();
+
+			std::vector<Entry> m_Entries;
+			size_t m_Count;
+
+			// Values back to the keys that point at them, so that destroyed objects can be removed.
+			std::unordered_multimap<const void*, std::string> m_KeysByValue;
+		};
+
+		// Caches the results of the engine's ID lookups. Entries are added the first time an ID is
+		// resolved, and removed when the object is renamed or destroyed. Lookups that fail aren't
+		// cached, so objects the engine creates on its own are always picked up. Everything except
+		// onObjectRemoved is only used from the main thread, so lookups don't need a lock.
+		class ObjectIdIndex {
+		public:
+			static ObjectIdIndex& getInstance() { return singleton; };
+
+			// Lookups into the cache. Returns nullptr if the ID hasn't been cached.
+			TES3::BaseObject* findObject(const char* id);
+			TES3::Reference* findActorClone(const char* baseId);
+
+			TES3::GlobalVariable* findGlobal(const char* id);
+
+			void cacheObject(const char* id, TES3::BaseObject* object);
+			void cacheActorClone(const char* baseId, TES3::Reference* reference);
+			void cacheGlobal(const char* id, TES3::GlobalVariable* global);
+
+			// Lookups of a script's local variables by name. Returns the variable type, or 0 if the name
+			// hasn't been cached for that script.
+			char findLocalVariable(const TES3::Script* script, const char* name, unsigned int* out_index);
+			void cacheLocalVariable(const TES3::Script* script, const char* name, char type, unsigned int index);
+
+			// Returns the first sound generator for a creature ID and sound type. The sound generator
+			// list doesn't change after the game data is loaded, so missing results are cached too.
+			// Generator names are matched case-sensitively, so the cache is keyed the same way.
+			TES3::SoundGenerator* getSoundGenerator(const char* creatureId, TES3::SoundType type);
+
+			// Removes an object from the cache before it is destroyed or changes its ID. Safe to call from any
+			// thread; removals from other threads are applied when the main thread next uses the cache.
+			void onObjectRemoved(const void* object);
+
+			// Forgets everything. Used when a game is loaded.
+			void clear();
+
+		private:
+			ObjectIdIndex() = default;
+
+			static ObjectIdIndex singleton;
+
+			void removeObject(const void* object);
+
+			// Applies removals made on other threads.
+			void processPendingRemovals();
+
+			// Sound generators found for each creature, indexed by sound type.
+			struct SoundGeneratorSet {
+				TES3::SoundGenerator* generators[8] = {};
+				bool searched[8] = {};
+			};
+
+			ObjectIdTable m_Objects;
+			ObjectIdTable m_ActorClones;
+			std::unordered_map<std::string, SoundGeneratorSet> m_SoundGenerators;
+			ObjectIdTable m_Globals;
+
+			// Local variables for each script. Values pack the variable's index and type together.
+			std::unordered_map<const TES3::Script*, std::unique_ptr<ObjectIdTable>> m_LocalVariables;
+
+			// Objects destroyed on the background loading thread. The overflow list is only used if the
+			// queue fills up.
+			LockFreeQueue<const void*, 4096> m_PendingRemovals;
+			std::atomic<bool> m_PendingRemovalsOverflowed { false };
+			std::mutex m_PendingRemovalsOverflowMutex;
+			std::vector<const void*> m_PendingRemovalsOverflow;
+		};
+	}
+}
@@ -0,0 +1,176 @@
+#include "ObjectTypeIndex.h"
+
+#include "TES3Collections.h"
+#include "TES3DataHandler.h"
+#include "TES3Object.h"
+
+#include <Windows.h>
+
+namespace mwse {
+	namespace tes3 {
+		ObjectTypeIndex ObjectTypeIndex::singleton;
+
+		ObjectTypeIndex::ObjectTypeIndex() :
+			m_TrackedSize(0),
+			m_Invalid(true),
+			m_Generation(0),
+			m_HasPendingChanges(false)
+		{
+
+		}
+
+		const std::vector<TES3::Object*>& ObjectTypeIndex::getObjects(unsigned int objectType) {
+			update();
+			return m_Lists[objectType].objects;
+		}
+
+		size_t ObjectTypeIndex::getCount(unsigned int objectType) {
+			update();
+			auto result = m_Lists.find(objectType);
+			if (result == m_Lists.end()) {
+				return 0;
+			}
+			return result->second.count;
+		}
+
+		static bool isMainThread() {
+			auto dataHandler = TES3::DataHandler::get();
+			return dataHandler == nullptr || GetCurrentThreadId() == dataHandler->mainThreadID;
+		}
+
+		void ObjectTypeIndex::onObjectAdded(TES3::Object* object) {
+			if (!isMainThread()) {
+				std::lock_guard<std::mutex> lock(m_PendingChangesMutex);
+				m_PendingChanges.push_back({ object, true });
+				m_HasPendingChanges = true;
+				return;
+			}
+
+			processPendingChanges();
+			addObject(object);
+		}
+
+		void ObjectTypeIndex::onObjectRemoved(TES3::Object* object) {
+			if (!isMainThread()) {
+				std::lock_guard<std::mutex> lock(m_PendingChangesMutex);
+				m_PendingChanges.push_back({ object, false });
+				m_HasPendingChanges = true;
+				return;
+			}
+
+			processPendingChanges();
+			removeObject(object);
+		}
+
+		void ObjectTypeIndex::addObject(TES3::Object* object) {
+			if (m_Invalid || m_Locations.count(object)) {
+				return;
+			}
+
+			auto& list = m_Lists[object->objectType];
+			m_Locations[object] = { object->objectType, list.objects.size(), m_Generation };
+			list.objects.push_back(object);
+			list.count++;
+			m_TrackedSize++;
+		}
+
+		void ObjectTypeIndex::removeObject(TES3::Object* object) {
+			if (m_Invalid) {
+				return;
+			}
+
+			// Objects removed from the data handler are seen again when they are destroyed.
+			auto location = m_Locations.find(object);
+			if (location == m_Locations.end()) {
+				return;
+			}
+
+			auto& list = m_Lists[location->second.objectType];
+			list.objects[location->second.position] = nullptr;
+			list.count--;
+			m_TrackedSize--;
+			m_Locations.erase(location);
+		}
+
+		void ObjectTypeIndex::processPendingChanges() {
+			if (!m_HasPendingChanges) {
+				return;
+			}
+
+			std::vector<PendingChange> changes;
+			{
+				std::lock_guard<std::mutex> lock(m_PendingChangesMutex);
+				changes.swap(m_PendingChanges);
+				m_HasPendingChanges = false;
+			}
+
+			for (const auto& change : changes) {
+				if (change.added) {
+					addObject(change.object);
+				}
+				else {
+					removeObject(change.object);
+				}
+			}
+		}
+
+		void ObjectTypeIndex::invalidate() {
+			m_Invalid = true;
+		}
+
+		void ObjectTypeIndex::update() {
+			auto dataHandler = TES3::DataHandler::get();
+			if (dataHandler == nullptr || dataHandler->nonDynamicData == nullptr) {
+				return;
+			}
+
+			processPendingChanges();
+
+			// Objects created by the engine itself don't pass through our hooks, but they do change the list size.
+			auto objectList = dataHandler->nonDynamicData->list;
+			if (!m_Invalid && objectList->size == m_TrackedSize) {
+				return;
+			}
+
+			m_Invalid = false;
+			m_Generation++;
+
+			// Iterators may be partway through the lists, so existing entries are left where they are.
+			// New objects are appended, and objects no longer in the engine's list are nulled.
+			for (TES3::Object* object = objectList->head; object; object = object->nextInCollection) {
+				auto location = m_Locations.find(object);
+				if (location != m_Locations.end()) {
+					// The address may have been reused by an object of another type.
+					if (location->second.objectType == object->objectType) {
+						location->second.generation = m_Generation;
+						continue;
+					}
+
+					auto& oldList = m_Lists[location->second.objectType];
+					oldList.objects[location->second.position] = nullptr;
+					oldList.count--;
+					m_Locations.erase(location);
+				}
+
+				auto& list = m_Lists[object->objectType];
+				m_Locations[object] = { object->objectType, list.objects.size(), m_Generation };
+				list.objects.push_back(object);
+				list.count++;
+			}
+
+			for (auto itt = m_Locations.begin(); itt != m_Locations.end();) {
+				if (itt->second.generation != m_Generation) {
+					auto& list = m_Lists[itt->second.objectType];
+					list.objects[itt->second.position] = nullptr;
+					list.count--;
+					itt = m_Locations.erase(itt);
+				}
+				else {
+					itt++;
+				}
+			}
+
+			m_TrackedSize = objectList->size;
+		}
+	}
+}
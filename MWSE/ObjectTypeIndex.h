@@ -0,0 +1,83 @@
+#pragma once
+
+#include "TES3Defines.h"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mwse {
+	namespace tes3 {
+		// Lists of the game's non-dynamic objects, grouped by object type. The lists are built on first
+		// use in the order of the data handler's object list. Objects added later are appended. When the
+		// engine's object list changes in a way we didn't see, the lists are checked against it again,
+		// but entries never move, so iterators over them keep working.
+		class ObjectTypeIndex {
+		public:
+			static ObjectTypeIndex& getInstance() { return singleton; };
+
+			// Gets all objects of a given type. Entries may be null if an object was deleted since the
+			// list was built, so that positions stay stable while iterating.
+			const std::vector<TES3::Object*>& getObjects(unsigned int objectType);
+
+			// Gets the number of live objects of a given type.
+			size_t getCount(unsigned int objectType);
+
+			// Called when objects are added to or removed from the data handler's object list, or
+			// destroyed. Removed objects leave a null entry behind. Safe to call from any thread;
+			// changes from other threads are applied when the main thread next uses the index.
+			void onObjectAdded(TES3::Object* object);
+			void onObjectRemoved(TES3::Object* object);
+
+			// Forces a rebuild before the next use. Safe to call from any thread.
+			void invalidate();
+
+		private:
+			ObjectTypeIndex();
+
+			static ObjectTypeIndex singleton;
+
+			struct TypeList {
+				std::vector<TES3::Object*> objects;
+				size_t count = 0;
+			};
+
+			// Where each object is in the lists.
+			struct Location {
+				unsigned int objectType;
+				size_t position;
+
+				// The last check against the engine's list that found this object.
+				unsigned int generation;
+			};
+
+			// Checks the lists against the engine's list if they are out of date.
+			void update();
+
+			void addObject(TES3::Object* object);
+			void removeObject(TES3::Object* object);
+
+			// Applies changes made on other threads.
+			void processPendingChanges();
+
+			std::unordered_map<unsigned int, TypeList> m_Lists;
+			std::unordered_map<TES3::Object*, Location> m_Locations;
+
+			// The size of the engine's object list when the lists last matched it.
+			size_t m_TrackedSize;
+
+			std::atomic<bool> m_Invalid;
+			unsigned int m_Generation;
+
+			// Objects added or removed on the background loading thread, in order.
+			struct PendingChange {
+				TES3::Object* object;
+				bool added;
+			};
+			std::mutex m_PendingChangesMutex;
+			std::vector<PendingChange> m_PendingChanges;
+			std::atomic<bool> m_HasPendingChanges;
+		};
+	}
+}
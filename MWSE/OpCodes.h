@@ -494,6 +494,7 @@ namespace mwse {
 			xClearArray = 0x395C,
 			xContentList = 0x3F03,
 			xContentListFiltered = 0x3F07,
+			xCopyArray = 0x3961,
 			xCos = 0x3832,
 			xCreateArray = 0x3931,
 			xCreateSpell = 0x3949,
@@ -517,12 +518,17 @@ namespace mwse {
 			xFileWriteShort = 0x3C31,
 			xFileWriteString = 0x3C34,
 			xFileWriteText = 0x3F09,
+			xFillArray = 0x3960,
+			xFindArrayValue = 0x3963,
 			xFirstItem = 0x3C1E,
 			xFirstNPC = 0x3C1A,
 			xFirstStatic = 0x3C1F,
 			xFloatsToLong = 0x3922,
 			xGetAlchemyInfo = 0x395F,
+			xGetArrayMax = 0x3966,
+			xGetArrayMin = 0x3965,
 			xGetArraySize = 0x395B,
+			xGetArraySum = 0x3964,
 			xGetArrayValue = 0x3932,
 			xGetAttribute = 0x3952,
 			xGetBaseAcrobatics = 0x3901,
@@ -675,6 +681,7 @@ namespace mwse {
 			xSetWeight = 0x3E62,
 			xShift = 0x3935,
 			xSin = 0x3831,
+			xSortArray = 0x3962,
 			xSpellList = 0x3926,
 			xSqrt = 0x3838,
 			xStartCombat = 0x3C21,
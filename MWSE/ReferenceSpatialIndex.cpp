@@ -0,0 +1,262 @@
+#include "ReferenceSpatialIndex.h"
+
+#include "TES3Cell.h"
+#include "TES3DataHandler.h"
+#include "TES3Reference.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+namespace mwse {
+	namespace tes3 {
+		ReferenceSpatialIndex ReferenceSpatialIndex::singleton;
+
+		ReferenceSpatialIndex::ReferenceSpatialIndex() :
+			m_Signature({ 0, 0 }),
+			m_Invalid(true),
+			m_Stale(true)
+		{
+
+		}
+
+		void ReferenceSpatialIndex::invalidate() {
+			m_Invalid = true;
+		}
+
+		void ReferenceSpatialIndex::onFrame() {
+			m_Stale = true;
+		}
+
+		void ReferenceSpatialIndex::onReferenceMoved(TES3::Reference* reference) {
+			if (m_Invalid) {
+				return;
+			}
+
+			auto result = m_EntryLookup.find(reference);
+			if (result != m_EntryLookup.end()) {
+				updateEntry(result->second);
+			}
+		}
+
+		long long ReferenceSpatialIndex::getKey(int x, int y) {
+			return (long long(x) << 32) | (unsigned int)(y);
+		}
+
+		// Grid coordinates are clamped well inside the range of int, so ranges can always be iterated.
+		const float GridCoordinateLimit = float(INT_MAX / 4);
+
+		int ReferenceSpatialIndex::getGridCoordinate(float value) {
+			float coordinate = std::floor(value / GridSize);
+			return int(std::max(-GridCoordinateLimit, std::min(coordinate, GridCoordinateLimit)));
+		}
+
+		// Calls a function for each reference list of each active cell.
+		template <typename Function>
+		static void forEachActiveReferenceList(Function function) {
+			auto dataHandler = TES3::DataHandler::get();
+			if (dataHandler == nullptr) {
+				return;
+			}
+
+			auto visitCell = [&](TES3::Cell* cell) {
+				function(cell->actors);
+				function(cell->activators);
+				function(cell->statics);
+			};
+
+			if (dataHandler->currentInteriorCell) {
+				visitCell(dataHandler->currentInteriorCell);
+			}
+			else {
+				for (size_t i = 0; i < 9; i++) {
+					auto cellData = dataHandler->exteriorCellData[i];
+					if (cellData && cellData->size >= 1 && cellData->cell) {
+						visitCell(cellData->cell);
+					}
+				}
+			}
+		}
+
+		ReferenceSpatialIndex::Signature ReferenceSpatialIndex::getActiveReferenceSignature() {
+			// The hash is a sum, so it doesn't depend on the order of the references.
+			Signature signature = { 0, 0 };
+			std::hash<TES3::Reference*> hasher;
+			forEachActiveReferenceList([&](const TES3::ReferenceList& list) {
+				for (auto reference = list.head; reference; reference = reinterpret_cast<TES3::Reference*>(reference->nextInCollection)) {
+					signature.count++;
+					signature.hash += hasher(reference) * 2654435761u;
+				}
+			});
+			return signature;
+		}
+
+		void ReferenceSpatialIndex::update() {
+			// References may have been added or removed without a cell change.
+			if (!m_Invalid && m_Stale && getActiveReferenceSignature() != m_Signature) {
+				m_Invalid = true;
+			}
+
+			if (m_Invalid) {
+				rebuild();
+			}
+			else if (m_Stale) {
+				for (size_t i = 0; i < m_Entries.size(); i++) {
+					updateEntry(i);
+				}
+			}
+
+			m_Stale = false;
+		}
+
+		void ReferenceSpatialIndex::rebuild() {
+			m_Invalid = false;
+
+			m_Entries.clear();
+			m_Buckets.clear();
+			m_EntryLookup.clear();
+			m_Signature = getActiveReferenceSignature();
+
+			forEachActiveReferenceList([&](const TES3::ReferenceList& list) {
+				for (auto reference = list.head; reference; reference = reinterpret_cast<TES3::Reference*>(reference->nextInCollection)) {
+					Entry entry;
+					entry.reference = reference;
+					entry.position = reference->position;
+					entry.key = getKey(getGridCoordinate(entry.position.x), getGridCoordinate(entry.position.y));
+
+					m_EntryLookup[reference] = m_Entries.size();
+					m_Entries.push_back(entry);
+					addToBucket(m_Entries.size() - 1);
+				}
+			});
+		}
+
+		void ReferenceSpatialIndex::addToBucket(size_t entryIndex) {
+			m_Buckets[m_Entries[entryIndex].key].push_back(entryIndex);
+		}
+
+		void ReferenceSpatialIndex::removeFromBucket(size_t entryIndex) {
+			auto bucket = m_Buckets.find(m_Entries[entryIndex].key);
+			if (bucket == m_Buckets.end()) {
+				return;
+			}
+
+			auto& indices = bucket->second;
+			auto position = std::find(indices.begin(), indices.end(), entryIndex);
+			if (position != indices.end()) {
+				*position = indices.back();
+				indices.pop_back();
+			}
+		}
+
+		void ReferenceSpatialIndex::updateEntry(size_t entryIndex) {
+			Entry& entry = m_Entries[entryIndex];
+			const TES3::Vector3& position = entry.reference->position;
+			if (position.x == entry.position.x && position.y == entry.position.y && position.z == entry.position.z) {
+				return;
+			}
+
+			entry.position = position;
+
+			long long key = getKey(getGridCoordinate(position.x), getGridCoordinate(position.y));
+			if (key != entry.key) {
+				removeFromBucket(entryIndex);
+				entry.key = key;
+				addToBucket(entryIndex);
+			}
+		}
+
+		template <typename Test>
+		std::vector<TES3::Reference*> ReferenceSpatialIndex::find(float minX, float minY, float maxX, float maxY, const std::vector<unsigned int>& types, Test test) {
+			update();
+
+			int gridMinX = getGridCoordinate(minX);
+			int gridMinY = getGridCoordinate(minY);
+			int gridMaxX = getGridCoordinate(maxX);
+			int gridMaxY = getGridCoordinate(maxY);
+
+			std::vector<TES3::Reference*> results;
+			auto searchBucket = [&](const std::vector<size_t>& bucket) {
+				for (size_t entryIndex : bucket) {
+					const Entry& entry = m_Entries[entryIndex];
+					TES3::Reference* reference = entry.reference;
+
+					// Ignore references that are pending deletion.
+					if (reference->objectFlags & TES3::ObjectFlag::Delete) {
+						continue;
+					}
+
+					if (!types.empty() && std::find(types.begin(), types.end(), (unsigned int)reference->baseObject->objectType) == types.end()) {
+						continue;
+					}
+
+					if (test(entry.position)) {
+						results.push_back(reference);
+					}
+				}
+			};
+
+			if (gridMaxX < gridMinX || gridMaxY < gridMinY) {
+				return results;
+			}
+
+			// For large areas, it's cheaper to go through the occupied buckets than every square in the range.
+			long long squareCount = (long long(gridMaxX) - gridMinX + 1) * (long long(gridMaxY) - gridMinY + 1);
+			if (squareCount > (long long)m_Buckets.size()) {
+				for (const auto& bucket : m_Buckets) {
+					int x = int(bucket.first >> 32);
+					int y = int((unsigned int)bucket.first);
+					if (x >= gridMinX && x <= gridMaxX && y >= gridMinY && y <= gridMaxY) {
+						searchBucket(bucket.second);
+					}
+				}
+				return results;
+			}
+
+			for (int x = gridMinX; x <= gridMaxX; x++) {
+				for (int y = gridMinY; y <= gridMaxY; y++) {
+					auto bucket = m_Buckets.find(getKey(x, y));
+					if (bucket != m_Buckets.end()) {
+						searchBucket(bucket->second);
+					}
+				}
+			}
+
+			return results;
+		}
+
+		static bool isFinite(const TES3::Vector3& vector) {
+			return std::isfinite(vector.x) && std::isfinite(vector.y) && std::isfinite(vector.z);
+		}
+
+		std::vector<TES3::Reference*> ReferenceSpatialIndex::findInRadius(const TES3::Vector3& position, float radius, const std::vector<unsigned int>& types) {
+			if (!std::isfinite(radius) || !isFinite(position)) {
+				throw std::invalid_argument("Search position and radius must be finite.");
+			}
+
+			float radiusSquared = radius * radius;
+			return find(position.x - radius, position.y - radius, position.x + radius, position.y + radius, types,
+				[&](const TES3::Vector3& test) {
+				float dx = test.x - position.x;
+				float dy = test.y - position.y;
+				float dz = test.z - position.z;
+				return dx * dx + dy * dy + dz * dz <= radiusSquared;
+			});
+		}
+
+		std::vector<TES3::Reference*> ReferenceSpatialIndex::findInBox(const TES3::Vector3& minimum, const TES3::Vector3& maximum, const std::vector<unsigned int>& types) {
+			if (!isFinite(minimum) || !isFinite(maximum)) {
+				throw std::invalid_argument("Search box must be finite.");
+			}
+
+			return find(minimum.x, minimum.y, maximum.x, maximum.y, types,
+				[&](const TES3::Vector3& test) {
+				return test.x >= minimum.x && test.x <= maximum.x
+					&& test.y >= minimum.y && test.y <= maximum.y
+					&& test.z >= minimum.z && test.z <= maximum.z;
+			});
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "TES3Defines.h"
+#include "TES3Vectors.h"
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+namespace mwse {
+	namespace tes3 {
+		// A uniform grid over the references in the active cells, for fast proximity queries. The
+		// grid is rebuilt lazily when the active cells change, and moved references are rebucketed
+		// at most once per frame, the first time the index is queried that frame.
+		class ReferenceSpatialIndex {
+		public:
+			static ReferenceSpatialIndex& getInstance() { return singleton; };
+
+			// Requests a full rebuild before the next query. Safe to call from any thread.
+			void invalidate();
+
+			// Lets the index know a new frame has started, so references need to be checked for movement.
+			void onFrame();
+
+			// Immediately updates a reference that was moved by us.
+			void onReferenceMoved(TES3::Reference* reference);
+
+			// Find all references within a sphere or axis-aligned box. If types is not empty, only
+			// references whose base object is one of the given types are returned. Throws if the
+			// radius or box isn't finite.
+			std::vector<TES3::Reference*> findInRadius(const TES3::Vector3& position, float radius, const std::vector<unsigned int>& types);
+			std::vector<TES3::Reference*> findInBox(const TES3::Vector3& minimum, const TES3::Vector3& maximum, const std::vector<unsigned int>& types);
+
+		private:
+			ReferenceSpatialIndex();
+
+			static ReferenceSpatialIndex singleton;
+
+			// Width of each grid square, in game units. An exterior cell is 8192 units wide.
+			static const int GridSize = 1024;
+
+			struct Entry {
+				TES3::Reference* reference;
+				TES3::Vector3 position;
+				long long key;
+			};
+
+			static long long getKey(int x, int y);
+			static int getGridCoordinate(float value);
+
+			// Makes sure the index reflects the current state of the active cells.
+			void update();
+			void rebuild();
+			void addToBucket(size_t entryIndex);
+			void removeFromBucket(size_t entryIndex);
+			void updateEntry(size_t entryIndex);
+
+			// Identifies the set of references in the active cells, used to detect added or removed references.
+			// Adding and removing a reference in the same frame keeps the count, but changes the hash.
+			struct Signature {
+				size_t count;
+				size_t hash;
+
+				bool operator==(const Signature& other) const { return count == other.count && hash == other.hash; }
+				bool operator!=(const Signature& other) const { return !(*this == other); }
+			};
+			static Signature getActiveReferenceSignature();
+
+			template <typename Test>
+			std::vector<TES3::Reference*> find(float minX, float minY, float maxX, float maxY, const std::vector<unsigned int>& types, Test test);
+
+			std::vector<Entry> m_Entries;
+			std::unordered_map<long long, std::vector<size_t>> m_Buckets;
+			std::unordered_map<TES3::Reference*, size_t> m_EntryLookup;
+			Signature m_Signature;
+
+			std::atomic<bool> m_Invalid;
+			bool m_Stale;
+		};
+	}
+}
@@ -28,5 +28,8 @@ Stack::Stack()
 {
     stack_size = initial_stack_size;
     stack_storage = new StackItem_t[stack_size];
+#if MWSE_STACK_TYPE_TAGS
+    stack_types = new ItemType[stack_size];
+#endif
     stack_top = 0;
 }
@@ -23,11 +23,19 @@
 #define MWSE_DEBUG_STACK 0
 #define MWSE_PRINT_DETAILED_STACK_DUMP 0
 
+// Track what type of value was pushed for each stack item, and warn when it's popped as something else.
+#ifdef _DEBUG
+#define MWSE_STACK_TYPE_TAGS 1
+#else
+#define MWSE_STACK_TYPE_TAGS 0
+#endif
+
 #include "mwseString.h"
 #include "Flags.h"
 #include "Log.h"
 #include "StringUtil.h"
 
+#include <cstring>
 #include <stdexcept>
 
 /**
@@ -46,11 +54,15 @@
  *      Stack::getInstance().pushLong(value);
  *      ....
  *      long value = Stack::getInstance().popLong(value);
+ *
+ * Functions with many return values can push or pop them all at once:
+ *      Stack::getInstance().pushN(count, weight, name);
+ *      ....
+ *      Stack::getInstance().popN(name, weight, count);
  */
 namespace mwse {
 
     static const size_t initial_stack_size = 64;
-    static const size_t stack_grow_size = 32;
 
     class Stack {
         public:
@@ -58,6 +70,12 @@ namespace mwse {
 
             typedef unsigned int StackItem_t;
 
+			enum class ItemType : unsigned char {
+				Integer,
+				Float,
+				String
+			};
+
 			void pushByte(const char value)
 			{
 				push(static_cast<StackItem_t>(value));
@@ -72,43 +90,60 @@ namespace mwse {
             }
             void pushFloat(float value)
             {
-                push(*reinterpret_cast<StackItem_t*>(&value));
+                push(toItem(value), ItemType::Float);
             }
             void pushString(const mwseString& value)
             {
-                pushLong(value);
+                pushStringId(value);
             }
 			void pushString(const std::string& value)
 			{
-				pushLong(mwse::string::store::getOrCreate(value));
+				pushStringId(mwse::string::store::getOrCreate(value));
 			}
 			void pushString(const char* value)
 			{
-				if (value) {
-					pushLong(mwse::string::store::getOrCreate(value));
-				}
-				else {
-					pushLong(0);
-				}
+				pushStringId(value ? long(mwse::string::store::getOrCreate(value)) : 0);
+			}
+
+			// Pushes a string that is already in the string store, without looking it up again.
+			void pushStringId(const long id)
+			{
+				push(static_cast<StackItem_t>(id), ItemType::String);
+			}
+
+			// Pushes several values in order, growing the stack at most once. Flags are set from the last value.
+			template <typename... Args>
+			void pushN(const Args&... values)
+			{
+				reserve(stack_top + sizeof...(values));
+				StackItem_t lastItem = 0;
+				pushEach(lastItem, values...);
+				Flags::setFlags(lastItem);
 			}
 
 			char popByte(void)
 			{
-				return static_cast<char>(pop());
+				return static_cast<char>(pop(ItemType::Integer));
 			}
             short popShort(void)
             {
-                return static_cast<short>(pop());
+                return static_cast<short>(pop(ItemType::Integer));
             }
             long popLong(void)
             {
-                return static_cast<long>(pop());
+                return static_cast<long>(pop(ItemType::Integer));
             }
             float popFloat(void)
             {
-				int temp = pop();
-				return *reinterpret_cast<float*>(&temp);
+				return toFloat(pop(ItemType::Float));
             }
+
+			// Pops several values, starting with the top of the stack.
+			template <typename... Args>
+			void popN(Args&... values)
+			{
+				popEach(values...);
+			}
             //mwRef_t & popRef(void);
             void popFrames(size_t frame_count)  // pop <frame_count> frames from the stack`
             {
@@ -132,6 +167,34 @@ namespace mwse {
 				stack_top = 0;
 			}
 
+			// Makes sure the stack can hold at least the given number of items without growing.
+			void reserve(size_t count)
+			{
+				if (count <= stack_size) {
+					return;
+				}
+
+				// Grow geometrically, so that deep stacks don't keep reallocating.
+				size_t new_size = stack_size * 2;
+				while (new_size < count) {
+					new_size *= 2;
+				}
+
+				StackItem_t *new_stack = new StackItem_t[new_size];
+				std::memcpy(new_stack, stack_storage, stack_top * sizeof(StackItem_t));
+				delete [] stack_storage;
+				stack_storage = new_stack;
+
+#if MWSE_STACK_TYPE_TAGS
+				ItemType *new_types = new ItemType[new_size];
+				std::memcpy(new_types, stack_types, stack_top * sizeof(ItemType));
+				delete [] stack_types;
+				stack_types = new_types;
+#endif
+
+				stack_size = new_size;
+			}
+
 			// Prints information about the Stack to the MWSE log file.
 			void dump()
 			{
@@ -151,27 +214,30 @@ namespace mwse {
 
             static Stack singleton;
 
-            void push(StackItem_t value)
+            void push(StackItem_t value, ItemType type = ItemType::Integer)
             {
                 if (stack_top >= stack_size) {
-                    stack_size += stack_grow_size;
-                    StackItem_t *new_stack = new StackItem_t[stack_size];
-                    for (size_t i = 0; i < stack_top; i++) {
-                        new_stack[i] = stack_storage[i];
-                    }
-                    delete [] stack_storage;
-                    stack_storage = new_stack;
+                    reserve(stack_top + 1);
                 }
+                pushUnchecked(value, type);
+
+				Flags::setFlags(value);	//set flags
+            }
+
+			// Pushes without growing the stack or setting flags. Space must already be reserved.
+			void pushUnchecked(StackItem_t value, ItemType type)
+			{
 #if MWSE_DEBUG_STACK
                 log::getLog() << std::dec << "Stack: Pushing element " << stack_top << " as " << std::hex << value << "h" << std::endl;
 #endif
                 stack_storage[stack_top] = value;
+#if MWSE_STACK_TYPE_TAGS
+				stack_types[stack_top] = type;
+#endif
                 stack_top++;
+			}
 
-				Flags::setFlags(value);	//set flags
-            }
-    
-            StackItem_t pop()
+            StackItem_t pop(ItemType expectedType)
             {
                 if (stack_top == 0) {
 #if _DEBUG
@@ -182,11 +248,68 @@ namespace mwse {
                 stack_top --;
 #if MWSE_DEBUG_STACK
 				log::getLog() << std::dec << "Stack: Popping element " << stack_top << " as " << std::hex << stack_storage[stack_top] << "h" << std::endl;
+#endif
+#if MWSE_STACK_TYPE_TAGS
+				// Strings are ids, so they can be read as integers. Floats can't be mixed with either.
+				if ((expectedType == ItemType::Float) != (stack_types[stack_top] == ItemType::Float)) {
+					mwse::log::getLog() << __FUNCTION__ << ": Stack element " << std::dec << stack_top << " was pushed as a " << (stack_types[stack_top] == ItemType::Float ? "float" : "integer") << " but popped as a " << (expectedType == ItemType::Float ? "float" : "integer") << ". Check function definition." << std::endl;
+				}
 #endif
                 return stack_storage[stack_top];
             }
 
+			static StackItem_t toItem(float value)
+			{
+				StackItem_t item;
+				std::memcpy(&item, &value, sizeof(item));
+				return item;
+			}
+
+			static float toFloat(StackItem_t item)
+			{
+				float value;
+				std::memcpy(&value, &item, sizeof(value));
+				return value;
+			}
+
+			// Helpers for pushN and popN, picking the right conversion for each value's type.
+			void pushValue(StackItem_t& lastItem, char value) { lastItem = static_cast<StackItem_t>(value); pushUnchecked(lastItem, ItemType::Integer); }
+			void pushValue(StackItem_t& lastItem, short value) { lastItem = static_cast<StackItem_t>(value); pushUnchecked(lastItem, ItemType::Integer); }
+			void pushValue(StackItem_t& lastItem, int value) { lastItem = static_cast<StackItem_t>(value); pushUnchecked(lastItem, ItemType::Integer); }
+			void pushValue(StackItem_t& lastItem, long value) { lastItem = static_cast<StackItem_t>(value); pushUnchecked(lastItem, ItemType::Integer); }
+			void pushValue(StackItem_t& lastItem, float value) { lastItem = toItem(value); pushUnchecked(lastItem, ItemType::Float); }
+			void pushValue(StackItem_t& lastItem, const mwseString& value) { lastItem = static_cast<StackItem_t>(long(value)); pushUnchecked(lastItem, ItemType::String); }
+			void pushValue(StackItem_t& lastItem, const std::string& value) { lastItem = static_cast<StackItem_t>(mwse::string::store::getOrCreate(value)); pushUnchecked(lastItem, ItemType::String); }
+			void pushValue(StackItem_t& lastItem, const char* value) { lastItem = value ? static_cast<StackItem_t>(mwse::string::store::getOrCreate(value)) : 0; pushUnchecked(lastItem, ItemType::String); }
+
+			void pushEach(StackItem_t& lastItem) {}
+
+			template <typename T, typename... Rest>
+			void pushEach(StackItem_t& lastItem, const T& value, const Rest&... rest)
+			{
+				pushValue(lastItem, value);
+				pushEach(lastItem, rest...);
+			}
+
+			void popValue(char& value) { value = popByte(); }
+			void popValue(short& value) { value = popShort(); }
+			void popValue(int& value) { value = static_cast<int>(popLong()); }
+			void popValue(long& value) { value = popLong(); }
+			void popValue(float& value) { value = popFloat(); }
+
+			void popEach() {}
+
+			template <typename T, typename... Rest>
+			void popEach(T& value, Rest&... rest)
+			{
+				popValue(value);
+				popEach(rest...);
+			}
+
             StackItem_t * stack_storage;  // dynamically sized array
+#if MWSE_STACK_TYPE_TAGS
+			ItemType *  stack_types;    // type of each item in stack_storage
+#endif
             size_t      stack_size;     // current allocated size
             size_t      stack_top;      // current top (0=empty; 1=one item)
     };
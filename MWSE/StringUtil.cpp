@@ -4,8 +4,9 @@
 
 #include <algorithm>
 #include <cctype>
-#include <sstream>
-#include <iomanip>
+#include <cstdio>
+#include <unordered_set>
+#include <vector>
 
 namespace mwse {
 	namespace string {
@@ -17,22 +18,37 @@ namespace mwse {
 			// Static storage for strings, indexed by id.
 			StringMap_t store;
 
+			// Static storage for string ids, indexed by value.
+			StringIndex_t index;
+
+			// Reference counts for retained strings.
+			static std::unordered_map<long, unsigned int> retainCounts;
+
+			// Strings with an id below this were created before the last collection.
+			static long generationStartId = MWSE_STRING_STORE_FIRSTID;
+
+			static mwseString& insert(long id, mwseString&& value) {
+				mwseString& result = store.emplace(id, std::move(value)).first->second;
+
+				// Duplicate strings are still created by create(), so only index the first of any value.
+				index.emplace(result, id);
+
+				return result;
+			}
+
 			mwseString& create(const std::string& value) {
 				long id = nextId++;
-				store.insert(StringMap_t::value_type(id, mwseString(id, value)));
-				return get(id);
+				return insert(id, mwseString(id, value));
 			}
 
 			mwseString& create(const char* value) {
 				long id = nextId++;
-				store.insert(StringMap_t::value_type(id, mwseString(id, value)));
-				return get(id);
+				return insert(id, mwseString(id, value));
 			}
 
 			mwseString& create(const char* value, size_t length) {
 				long id = nextId++;
-				store.insert(StringMap_t::value_type(id, mwseString(id, value, length)));
-				return get(id);
+				return insert(id, mwseString(id, value, length));
 			}
 
 			bool clear() {
@@ -42,7 +58,10 @@ namespace mwse {
 				}
 
 				nextId = MWSE_STRING_STORE_FIRSTID;
+				generationStartId = MWSE_STRING_STORE_FIRSTID;
 				store.clear();
+				index.clear();
+				retainCounts.clear();
 
 				return cleared;
 			}
@@ -52,23 +71,11 @@ namespace mwse {
 			}
 
 			bool exists(const char* value) {
-				for (StringMap_t::iterator it = store.begin(); it != store.end(); it++) {
-					if (it->second.compare(value) == 0) {
-						return true;
-					}
-				}
-
-				return false;
+				return index.find(value) != index.end();
 			}
 
 			bool exists(const std::string& value) {
-				for (StringMap_t::iterator it = store.begin(); it != store.end(); it++) {
-					if (it->second.compare(value) == 0) {
-						return true;
-					}
-				}
-
-				return false;
+				return index.find(value) != index.end();
 			}
 
 			mwseString& get(const long id) {
@@ -81,18 +88,18 @@ namespace mwse {
 			}
 
 			mwseString& get(const std::string& value) {
-				for (StringMap_t::iterator it = store.begin(); it != store.end(); it++) {
-					if (it->second.compare(value) == 0) {
-						return it->second;
-					}
+				auto it = index.find(value);
+				if (it == index.end()) {
+					throw std::exception();
 				}
 
-				throw std::exception();
+				return get(it->second);
 			}
 
 			mwseString& getOrCreate(const char* value) {
-				if (exists(value)) {
-					return get(value);
+				auto it = index.find(value);
+				if (it != index.end()) {
+					return get(it->second);
 				}
 
 				return create(value);
@@ -102,41 +109,155 @@ namespace mwse {
 				std::string limitedValue = value;
 				limitedValue.resize(length, '\0');
 
-				if (exists(limitedValue.c_str())) {
-					return get(limitedValue.c_str());
-				}
-
-				return create(limitedValue.c_str());
+				return getOrCreate(limitedValue.c_str());
 			}
 
 			mwseString& getOrCreate(const std::string& value) {
-				if (exists(value)) {
-					return get(value);
+				auto it = index.find(value);
+				if (it != index.end()) {
+					return get(it->second);
 				}
 
 				return create(value);
 			}
+
+			bool retain(const long id) {
+				if (!exists(id)) {
+					return false;
+				}
+
+				retainCounts[id]++;
+				return true;
+			}
+
+			bool release(const long id) {
+				auto it = retainCounts.find(id);
+				if (it == retainCounts.end()) {
+					return false;
+				}
+
+				if (--it->second == 0) {
+					retainCounts.erase(it);
+				}
+				return true;
+			}
+
+			size_t collect() {
+				size_t collected = 0;
+
+				// Values whose indexed string was freed, while a duplicate may still be stored.
+				std::unordered_set<std::string> unindexed;
+
+				for (auto it = store.begin(); it != store.end();) {
+					long id = it->first;
+					if (id >= generationStartId || retainCounts.find(id) != retainCounts.end()) {
+						it++;
+						continue;
+					}
+
+					// Only drop the index entry if it points at this string, and not a duplicate.
+					auto indexEntry = index.find(it->second);
+					if (indexEntry != index.end() && indexEntry->second == id) {
+						index.erase(indexEntry);
+						unindexed.insert(it->second);
+					}
+
+					it = store.erase(it);
+					collected++;
+				}
+
+				// Index the oldest surviving duplicate in place of a freed string.
+				if (!unindexed.empty()) {
+					for (const auto& entry : store) {
+						if (unindexed.find(entry.second) == unindexed.end()) {
+							continue;
+						}
+
+						auto indexEntry = index.find(entry.second);
+						if (indexEntry == index.end()) {
+							index.emplace(entry.second, entry.first);
+						}
+						else if (entry.first < indexEntry->second) {
+							indexEntry->second = entry.first;
+						}
+					}
+				}
+
+				// Ids keep counting up, so that stale ids can't resolve to new strings.
+				generationStartId = nextId;
+
+				return collected;
+			}
 		}
 
-		std::string interpolate(const std::string& format, mwse::VMExecuteInterface &virtualMachine, bool* suppressNull, std::string* badCodes) {
-			std::string result;
+		//
+		// Format strings are parsed once into a list of tokens, then replayed against the stack each
+		// time they're used. Literal text, %n, %q and %% are all folded into literal tokens.
+		//
+
+		struct FormatToken {
+			enum class Type : unsigned char {
+				Literal,
+				Long,
+				Decimal,
+				Hex,
+				Float,
+				String
+			};
+
+			Type type;
+			size_t offset = 0;			// Literal: start of the text in ParsedFormat::literals.
+			size_t length = 0;			// Literal: length of the text. String: maximum characters, or npos.
+			size_t skip = 0;			// String: leading characters to skip.
+			int precision = 0;			// Float: digits after the decimal point.
+
+			FormatToken(Type t) : type(t) {}
+		};
+
+		struct ParsedFormat {
+			std::string literals;
+			std::vector<FormatToken> tokens;
+			std::string badCodes;
+			bool suppressNull = false;
+
+			void addLiteral(const char* text, size_t length) {
+				if (length == 0) {
+					return;
+				}
+
+				// Extend the previous literal if we can, rather than adding a new token.
+				if (tokens.empty() || tokens.back().type != FormatToken::Type::Literal) {
+					FormatToken token(FormatToken::Type::Literal);
+					token.offset = literals.length();
+					tokens.push_back(token);
+				}
+				tokens.back().length += length;
+				literals.append(text, length);
+			}
+
+			void addBadCode(const std::string& code) {
+				if (!badCodes.empty()) badCodes += " ";
+				badCodes += code;
+			}
+		};
 
-			*suppressNull = false;
+		// Dynamic format strings could otherwise grow the cache forever.
+		static const size_t maxCachedFormats = 512;
 
+		static void parseFormat(const std::string& format, ParsedFormat& parsed) {
 			size_t start = 0;
 			std::string current_code;
 			std::string number;
-			std::ostringstream convert;
 			while (start < format.length()) {
 				size_t end = format.find('%', start);
 				if (end == std::string::npos) {
-					result += format.substr(start);
+					parsed.addLiteral(format.c_str() + start, format.length() - start);
 					break;
 				}
-				result += format.substr(start, end - start);
+				parsed.addLiteral(format.c_str() + start, end - start);
 				end++;
 				if (end == format.length()) { // single trailing %
-					*suppressNull = true;
+					parsed.suppressNull = true;
 					break;
 				}
 				current_code = "%";
@@ -149,7 +270,7 @@ namespace mwse {
 				while (!done) {
 					char current_char = tolower(format.at(end));
 					if (current_char == '%' && current_code == "%") {
-						result += current_char;
+						parsed.addLiteral("%", 1);
 						end++;
 						parse_success = true;
 					}
@@ -181,53 +302,36 @@ namespace mwse {
 						end++;
 					}
 					else if (current_char == 'n' && current_code == "%") {
-						result += "\r\n";
+						parsed.addLiteral("\r\n", 2);
 						end++;
 						parse_success = true;
 					}
 					else if (current_char == 'q' && current_code == "%") {
-						result += '"';
+						parsed.addLiteral("\"", 1);
 						end++;
 						parse_success = true;
 					}
 					else if (current_char == 'l' && current_code == "%") {
-						if (!mwse::Stack::getInstance().empty()) {
-							long value = mwse::Stack::getInstance().popLong();
-							result.append(reinterpret_cast<char*>(&value), 4);
-						}
+						parsed.tokens.emplace_back(FormatToken::Type::Long);
 						end++;
 						parse_success = true;
 					}
 					else if (current_char == 'd' && current_code == "%") {
-						if (!Stack::getInstance().empty()) {
-							long value = mwse::Stack::getInstance().popLong();
-							convert.str("");
-							convert << std::dec << value;
-							result += convert.str();
-						}
+						parsed.tokens.emplace_back(FormatToken::Type::Decimal);
 						end++;
 						parse_success = true;
 					}
 					else if (current_char == 'h' && current_code == "%") {
-						if (!Stack::getInstance().empty()) {
-							long value = mwse::Stack::getInstance().popLong();
-							convert.str("");
-							convert << std::hex << value;
-							result += convert.str();
-						}
+						parsed.tokens.emplace_back(FormatToken::Type::Hex);
 						end++;
 						parse_success = true;
 					}
 					else if (current_char == 'f') {
 						if (!skip_set) {
-							if (!Stack::getInstance().empty()) {
-								float value = mwse::Stack::getInstance().popFloat();
-								// 6 = vsprintf default precision - mimic old version
-								if (!precision_set) precision = 6;
-								convert.str("");
-								convert << std::fixed << std::setprecision(precision) << value;
-								result += convert.str();
-							}
+							// 6 = vsprintf default precision - mimic old version
+							FormatToken token(FormatToken::Type::Float);
+							token.precision = precision_set ? precision : 6;
+							parsed.tokens.push_back(token);
 							parse_success = true;
 						}
 						else {
@@ -237,14 +341,10 @@ namespace mwse {
 						end++;
 					}
 					else if (current_char == 's') {
-						if (!mwse::Stack::getInstance().empty()) {
-							mwseString& value = virtualMachine.getString(mwse::Stack::getInstance().popLong());
-							if (value.isValid()) {
-								size_t substitute_start = std::min((size_t)skip, value.length());
-								if (!precision_set) precision = value.length();
-								result += value.substr(substitute_start, precision);
-							}
-						}
+						FormatToken token(FormatToken::Type::String);
+						token.skip = skip;
+						token.length = precision_set ? size_t(precision) : std::string::npos;
+						parsed.tokens.push_back(token);
 						end++;
 						parse_success = true;
 					}
@@ -257,12 +357,135 @@ namespace mwse {
 					}
 					if (parse_success || end >= format.length()) done = true;
 					if (done && !parse_success) {
-						if (*badCodes != "") *badCodes += " ";
-						*badCodes += current_code;
+						parsed.addBadCode(current_code);
 					}
 				}
 				start = end;
 			}
+		}
+
+		static const ParsedFormat& getParsedFormat(const std::string& format) {
+			// Keyed by the format text rather than where it came from. Formats can come from string
+			// variables, and xMessageFix rewrites the strings stored in script data.
+			static thread_local std::unordered_map<std::string, ParsedFormat> cache;
+
+			auto it = cache.find(format);
+			if (it != cache.end()) {
+				return it->second;
+			}
+
+			if (cache.size() >= maxCachedFormats) {
+				cache.clear();
+			}
+
+			ParsedFormat& parsed = cache[format];
+			parseFormat(format, parsed);
+			return parsed;
+		}
+
+		static void appendDecimal(std::string& result, long value) {
+			char buffer[24];
+			char* end = buffer + sizeof(buffer);
+			char* start = end;
+
+			unsigned long magnitude = value < 0 ? 0ul - static_cast<unsigned long>(value) : static_cast<unsigned long>(value);
+			do {
+				*--start = char('0' + magnitude % 10);
+				magnitude /= 10;
+			} while (magnitude != 0);
+
+			if (value < 0) {
+				*--start = '-';
+			}
+
+			result.append(start, end - start);
+		}
+
+		static void appendHex(std::string& result, long value) {
+			static const char digits[] = "0123456789abcdef";
+
+			char buffer[24];
+			char* end = buffer + sizeof(buffer);
+			char* start = end;
+
+			// Negative values are printed as their unsigned bit pattern, like std::hex.
+			unsigned long bits = static_cast<unsigned long>(value);
+			do {
+				*--start = digits[bits & 0xF];
+				bits >>= 4;
+			} while (bits != 0);
+
+			result.append(start, end - start);
+		}
+
+		static void appendFloat(std::string& result, float value, int precision) {
+			// Most values fit on the stack. Very large values or precisions are written directly into the result.
+			char buffer[64];
+			int length = snprintf(buffer, sizeof(buffer), "%.*f", precision, double(value));
+			if (length < 0) {
+				return;
+			}
+			else if (size_t(length) < sizeof(buffer)) {
+				result.append(buffer, length);
+			}
+			else {
+				size_t offset = result.length();
+				result.resize(offset + length + 1);
+				snprintf(&result[offset], length + 1, "%.*f", precision, double(value));
+				result.resize(offset + length);
+			}
+		}
+
+		const std::string& interpolate(const std::string& format, mwse::VMExecuteInterface &virtualMachine, bool* suppressNull, std::string* badCodes) {
+			static thread_local std::string result;
+			result.clear();
+
+			const ParsedFormat& parsed = getParsedFormat(format);
+
+			*suppressNull = parsed.suppressNull;
+			if (!parsed.badCodes.empty()) {
+				if (*badCodes != "") *badCodes += " ";
+				*badCodes += parsed.badCodes;
+			}
+
+			Stack& stack = Stack::getInstance();
+			for (const FormatToken& token : parsed.tokens) {
+				switch (token.type) {
+				case FormatToken::Type::Literal:
+					result.append(parsed.literals, token.offset, token.length);
+					break;
+				case FormatToken::Type::Long:
+					if (!stack.empty()) {
+						long value = stack.popLong();
+						result.append(reinterpret_cast<char*>(&value), 4);
+					}
+					break;
+				case FormatToken::Type::Decimal:
+					if (!stack.empty()) {
+						appendDecimal(result, stack.popLong());
+					}
+					break;
+				case FormatToken::Type::Hex:
+					if (!stack.empty()) {
+						appendHex(result, stack.popLong());
+					}
+					break;
+				case FormatToken::Type::Float:
+					if (!stack.empty()) {
+						appendFloat(result, stack.popFloat(), token.precision);
+					}
+					break;
+				case FormatToken::Type::String:
+					if (!stack.empty()) {
+						mwseString& value = virtualMachine.getString(stack.popLong());
+						if (value.isValid()) {
+							size_t substitute_start = std::min(token.skip, value.length());
+							result.append(value, substitute_start, token.length);
+						}
+					}
+					break;
+				}
+			}
 
 			return result;
 		}
@@ -24,18 +24,25 @@
 #include "VMExecuteInterface.h"
 #include "mwseString.h"
 
+#include <unordered_map>
+
 #define MWSE_STRING_STORE_FIRSTID 40000
 
 namespace mwse {
 	namespace string {
 		namespace store {
 			// Type of our string storage.
-			typedef std::map<long, mwseString> StringMap_t;
+			typedef std::unordered_map<long, mwseString> StringMap_t;
+
+			// Interning index, to find a stored string's id by its value.
+			typedef std::unordered_map<std::string, long> StringIndex_t;
 
 			extern long nextId;
 
 			extern StringMap_t store;
 
+			extern StringIndex_t index;
+
 			mwseString& create(const std::string& value);
 
 			mwseString& create(const char* value);
@@ -59,13 +66,25 @@ namespace mwse {
 			mwseString& getOrCreate(const char* value);
 
 			mwseString& getOrCreate(const char* value, size_t length);
+
+			// Keeps a string alive through collections. Each retain must be matched by a release.
+			bool retain(const long id);
+
+			bool release(const long id);
+
+			// Frees strings that were created before the previous collection and aren't retained.
+			// Strings created since then survive, so recently handed out ids remain valid for at
+			// least one more generation. Returns the number of strings freed.
+			size_t collect();
 		}
 
 		//
 		// String pattern searching functions.
 		//
 
-		std::string interpolate(const std::string& format, mwse::VMExecuteInterface &virtualMachine, bool* suppressNull, std::string* badCodes);
+		// Substitutes values from the stack into an MWSE format string. The returned string is reused
+		// by the next call on the same thread, so copy it if it needs to be kept.
+		const std::string& interpolate(const std::string& format, mwse::VMExecuteInterface &virtualMachine, bool* suppressNull, std::string* badCodes);
 
 		// Count how many results there should be based on the format string
 		bool enumerate(const char *format, int& substitutions, bool& eolmode);
@@ -32,8 +32,12 @@ namespace mwse {
 
 			state["mwse"]["string"] = LuaManager::getInstance().createTable();
 
+			// Strings created from lua are retained, so mods holding on to the id never see it freed.
+			// Mods that are done with a string can opt in to it being collected with mwse.string.release.
 			state["mwse"]["string"]["create"] = [](std::string value) -> int {
-				return mwse::string::store::getOrCreate(value.c_str());
+				long id = mwse::string::store::getOrCreate(value.c_str());
+				mwse::string::store::retain(id);
+				return id;
 			};
 
 			state["mwse"]["string"]["get"] = [](double value) -> sol::object {
@@ -45,6 +49,14 @@ namespace mwse {
 					return sol::nil;
 				}
 			};
+
+			state["mwse"]["string"]["retain"] = [](double value) {
+				return mwse::string::store::retain(value);
+			};
+
+			state["mwse"]["string"]["release"] = [](double value) {
+				return mwse::string::store::release(value);
+			};
 		}
 	}
 }
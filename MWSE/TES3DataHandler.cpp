@@ -11,6 +11,8 @@
 #include "LuaLoadedGameEvent.h"
 
 #include "TES3Util.h"
+#include "ObjectIdIndex.h"
+#include "ObjectTypeIndex.h"
 
 #include "TES3MobilePlayer.h"
 #include "TES3Reference.h"
@@ -115,11 +117,28 @@ namespace TES3 {
 	}
 
 	BaseObject* NonDynamicData::resolveObject(const char* id) {
-		return reinterpret_cast<BaseObject*(__thiscall *)(NonDynamicData*, const char*)>(TES3_NonDynamicData_resolveObject)(this, id);
+		// Check our own index before asking the engine.
+		auto& index = mwse::tes3::ObjectIdIndex::getInstance();
+		BaseObject* object = index.findObject(id);
+		if (object == nullptr) {
+			object = reinterpret_cast<BaseObject*(__thiscall *)(NonDynamicData*, const char*)>(TES3_NonDynamicData_resolveObject)(this, id);
+			if (object) {
+				index.cacheObject(id, object);
+			}
+		}
+		return object;
 	}
 
 	Reference* NonDynamicData::findFirstCloneOfActor(const char* baseId) {
-		return reinterpret_cast<Reference*(__thiscall *)(NonDynamicData*, const char*)>(TES3_NonDynamicData_findFirstCloneOfActor)(this, baseId);
+		auto& index = mwse::tes3::ObjectIdIndex::getInstance();
+		Reference* reference = index.findActorClone(baseId);
+		if (reference == nullptr) {
+			reference = reinterpret_cast<Reference*(__thiscall *)(NonDynamicData*, const char*)>(TES3_NonDynamicData_findFirstCloneOfActor)(this, baseId);
+			if (reference) {
+				index.cacheActorClone(baseId, reference);
+			}
+		}
+		return reference;
 	}
 
 	Spell* NonDynamicData::getSpellById(const char* id) {
@@ -135,7 +154,15 @@ namespace TES3 {
 	}
 
 	GlobalVariable* NonDynamicData::findGlobalVariable(const char* name) {
-		return reinterpret_cast<GlobalVariable*(__thiscall *)(NonDynamicData*, const char*)>(TES3_NonDynamicData_findGlobalVariable)(this, name);
+		auto& index = mwse::tes3::ObjectIdIndex::getInstance();
+		GlobalVariable* global = index.findGlobal(name);
+		if (global == nullptr) {
+			global = reinterpret_cast<GlobalVariable*(__thiscall *)(NonDynamicData*, const char*)>(TES3_NonDynamicData_findGlobalVariable)(this, name);
+			if (global) {
+				index.cacheGlobal(name, global);
+			}
+		}
+		return global;
 	}
 
 	Dialogue* NonDynamicData::findDialogue(const char* name) {
@@ -152,10 +179,17 @@ namespace TES3 {
 	}
 
 	bool NonDynamicData::addNewObject(BaseObject* object) {
-		return reinterpret_cast<signed char(__thiscall *)(NonDynamicData*, BaseObject*)>(TES3_NonDynamicData_addNewObject)(this, object);
+		bool added = reinterpret_cast<signed char(__thiscall *)(NonDynamicData*, BaseObject*)>(TES3_NonDynamicData_addNewObject)(this, object);
+		if (added) {
+			mwse::tes3::ObjectIdIndex::getInstance().cacheObject(object->getObjectID(), object);
+			mwse::tes3::ObjectTypeIndex::getInstance().onObjectAdded(static_cast<Object*>(object));
+		}
+		return added;
 	}
 
 	void NonDynamicData::deleteObject(BaseObject* object) {
+		mwse::tes3::ObjectIdIndex::getInstance().onObjectRemoved(object);
+		mwse::tes3::ObjectTypeIndex::getInstance().onObjectRemoved(static_cast<Object*>(object));
 		reinterpret_cast<void(__thiscall *)(NonDynamicData*, BaseObject*)>(TES3_NonDynamicData_deleteObject)(this, object);
 	}
 
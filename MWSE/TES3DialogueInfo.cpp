@@ -25,9 +25,11 @@ namespace TES3 {
 		bool result = TES3_DialogueInfo_filter(this, actor, reference, source, dialogue);
 
 		sol::table eventData = mwse::lua::LuaManager::getInstance().triggerEvent(new mwse::lua::event::InfoFilterEvent(this, actor, reference, source, dialogue, result));
-		sol::object passes = eventData["passes"];
-		if (passes.is<bool>()) {
-			result = passes.as<bool>();
+		if (eventData.valid()) {
+			sol::object passes = eventData["passes"];
+			if (passes.is<bool>()) {
+				result = passes.as<bool>();
+			}
 		}
 
 		return result;
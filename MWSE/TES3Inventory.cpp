@@ -1,6 +1,7 @@
 #include "TES3Inventory.h"
 
 #include "TES3Util.h"
+#include "InventoryStackIndex.h"
 
 #include "TES3Item.h"
 
@@ -18,29 +19,39 @@ namespace TES3 {
 	// Inventory
 	//
 
-	const auto TES3_Inventory_findItemStack = reinterpret_cast<ItemStack* (__thiscall*)(Inventory*, Object*)>(0x49A6C0);
 	ItemStack* Inventory::findItemStack(Object* item) {
-		return TES3_Inventory_findItemStack(this, item);
+		return mwse::tes3::InventoryStackIndex::getInstance().findItemStack(this, item);
 	}
 
 	const auto TES3_Inventory_AddItem = reinterpret_cast<int(__thiscall*)(Inventory*, MobileActor *, Item *, int, bool, ItemData **)>(0x498530);
 	int Inventory::addItem(MobileActor * mobile, Item * item, int count, bool something, ItemData ** itemDataRef) {
-		return TES3_Inventory_AddItem(this, mobile, item, count, something, itemDataRef);
+		auto& index = mwse::tes3::InventoryStackIndex::getInstance();
+		int countBefore = index.beginItemChange(this, item);
+		int result = TES3_Inventory_AddItem(this, mobile, item, count, something, itemDataRef);
+		index.endItemChange(this, item, countBefore);
+		return result;
 	}
 
 	const auto TES3_Inventory_RemoveItemWithData = reinterpret_cast<void(__thiscall*)(Inventory*, MobileActor*, Item *, ItemData *, int, bool)>(0x499550);
 	void Inventory::removeItemWithData(MobileActor * mobile, Item * item, ItemData * itemData, int count, bool deleteStackData) {
+		auto& index = mwse::tes3::InventoryStackIndex::getInstance();
+		int countBefore = index.beginItemChange(this, item);
 		TES3_Inventory_RemoveItemWithData(this, mobile, item, itemData, count, deleteStackData);
+		index.endItemChange(this, item, countBefore);
 	}
 
 	const auto TES3_Inventory_DropItem = reinterpret_cast<void(__thiscall*)(Inventory*, MobileActor*, Item *, ItemData *, int, Vector3, Vector3, bool)>(0x49B090);
 	void Inventory::dropItem(MobileActor* mobileActor, Item * item, ItemData * itemData, int count, Vector3 position, Vector3 orientation, bool unknown) {
+		auto& index = mwse::tes3::InventoryStackIndex::getInstance();
+		int countBefore = index.beginItemChange(this, item);
 		TES3_Inventory_DropItem(this, mobileActor, item, itemData, count, position, orientation, unknown);
+		index.endItemChange(this, item, countBefore);
 	}
 
 	const auto TES3_Inventory_resolveLeveledLists = reinterpret_cast<void(__thiscall*)(Inventory*, MobileActor*)>(0x49A190);
 	void Inventory::resolveLeveledLists(MobileActor* actor) {
 		TES3_Inventory_resolveLeveledLists(this, actor);
+		mwse::tes3::InventoryStackIndex::getInstance().invalidate(this);
 	}
 
 	bool Inventory::containsItem(Item * item, ItemData * data) {
@@ -50,18 +61,23 @@ namespace TES3 {
 		}
 
 		if (data) {
-			return stack->variables->contains(data);
+			return stack->variables && stack->variables->contains(data);
 		}
 
 		return false;
 	}
 
-	float Inventory::calculateContainedWeight() {
-		float weight = 0.0f;
-		for (auto i = iterator.head; i; i = i->next) {
-			weight += i->data->object->getWeight() * std::abs(i->data->count);
+	int Inventory::getItemCount(Item * item) {
+		ItemStack * stack = findItemStack(item);
+		if (stack == nullptr) {
+			return 0;
 		}
-		return weight;
+
+		return std::abs(stack->count);
+	}
+
+	float Inventory::calculateContainedWeight() {
+		return mwse::tes3::InventoryStackIndex::getInstance().getContainedWeight(this);
 	}
 
 	int Inventory::getSoulGemCount() {
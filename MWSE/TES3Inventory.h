@@ -62,6 +62,7 @@ namespace TES3 {
 		//
 
 		bool containsItem(Item * item, ItemData * data = nullptr);
+		int getItemCount(Item * item);
 
 		float calculateContainedWeight();
 
@@ -203,6 +203,16 @@ namespace mwse {
 				usertypeDefinition.set("contains", &TES3::Inventory::containsItem);
 				usertypeDefinition.set("dropItem", &TES3::Inventory::dropItem);
 				usertypeDefinition.set("calculateWeight", &TES3::Inventory::calculateContainedWeight);
+				usertypeDefinition.set("getItemCount", [](TES3::Inventory& self, sol::object item) {
+					TES3::Item * itemObject = nullptr;
+					if (item.is<const char*>()) {
+						itemObject = TES3::DataHandler::get()->nonDynamicData->resolveObjectByType<TES3::Item>(item.as<const char*>());
+					}
+					else if (item.is<TES3::Item*>()) {
+						itemObject = item.as<TES3::Item*>();
+					}
+					return itemObject ? self.getItemCount(itemObject) : 0;
+				});
 				usertypeDefinition.set("removeItem", [](TES3::Inventory& self, sol::table params) {
 					TES3::MobileActor * mact = getOptionalParamMobileActor(params, "mobile");
 					TES3::Item * item = getOptionalParamObject<TES3::Item>(params, "item");
@@ -147,13 +147,15 @@ namespace TES3 {
 	bool MobileActor::applyHealthDamage(float damage, bool flipDifficultyScale, bool scaleWithDifficulty, bool takeHealth) {
 		// Invoke our combat stop event and check if it is blocked.
 		mwse::lua::LuaManager& luaManager = mwse::lua::LuaManager::getInstance();
-		sol::table eventData = luaManager.triggerEvent(new mwse::lua::event::DamageEvent(this, damage));
-		if (eventData.valid()) {
-			if (eventData["block"] == true) {
-				return false;
+		if (mwse::lua::event::DamageEvent::getEventEnabled()) {
+			sol::table eventData = luaManager.triggerEvent(new mwse::lua::event::DamageEvent(this, damage));
+			if (eventData.valid()) {
+				if (eventData["block"] == true) {
+					return false;
+				}
+
+				damage = eventData["damage"];
 			}
-
-			damage = eventData["damage"];
 		}
 
 		bool result = reinterpret_cast<signed char(__thiscall *)(MobileActor*, float, bool, bool, bool)>(TES3_MobileActor_applyHealthDamage)(this, damage, flipDifficultyScale, scaleWithDifficulty, takeHealth);
@@ -173,10 +175,12 @@ namespace TES3 {
 		float speed = reinterpret_cast<float(__thiscall *)(MobileActor*)>(TES3_MobileActor_calculateRunSpeed)(this);
 
 		// Launch our event, and overwrite the speed with what was given back to us.
-		mwse::lua::LuaManager& luaManager = mwse::lua::LuaManager::getInstance();
-		sol::table eventData = luaManager.triggerEvent(new mwse::lua::event::CalculateMovementSpeed(mwse::lua::event::CalculateMovementSpeed::Run, this, speed));
-		if (eventData.valid()) {
-			speed = eventData["speed"];
+		if (mwse::lua::event::CalculateMovementSpeed::getEventEnabled(mwse::lua::event::CalculateMovementSpeed::Run)) {
+			mwse::lua::LuaManager& luaManager = mwse::lua::LuaManager::getInstance();
+			sol::table eventData = luaManager.triggerEvent(new mwse::lua::event::CalculateMovementSpeed(mwse::lua::event::CalculateMovementSpeed::Run, this, speed));
+			if (eventData.valid()) {
+				speed = eventData["speed"];
+			}
 		}
 
 		return speed;
@@ -187,10 +191,12 @@ namespace TES3 {
 		float speed = reinterpret_cast<float(__thiscall *)(MobileActor*)>(TES3_MobileActor_calculateSwimSpeed)(this);
 
 		// Launch our event, and overwrite the speed with what was given back to us.
-		mwse::lua::LuaManager& luaManager = mwse::lua::LuaManager::getInstance();
-		sol::table eventData = luaManager.triggerEvent(new mwse::lua::event::CalculateMovementSpeed(mwse::lua::event::CalculateMovementSpeed::Swim, this, speed));
-		if (eventData.valid()) {
-			speed = eventData["speed"];
+		if (mwse::lua::event::CalculateMovementSpeed::getEventEnabled(mwse::lua::event::CalculateMovementSpeed::Swim)) {
+			mwse::lua::LuaManager& luaManager = mwse::lua::LuaManager::getInstance();
+			sol::table eventData = luaManager.triggerEvent(new mwse::lua::event::CalculateMovementSpeed(mwse::lua::event::CalculateMovementSpeed::Swim, this, speed));
+			if (eventData.valid()) {
+				speed = eventData["speed"];
+			}
 		}
 
 		return speed;
@@ -205,10 +211,12 @@ namespace TES3 {
 		float speed = calculateSwimSpeed() * runMultiplier;
 
 		// Launch our event, and overwrite the speed with what was given back to us.
-		mwse::lua::LuaManager& luaManager = mwse::lua::LuaManager::getInstance();
-		sol::table eventData = luaManager.triggerEvent(new mwse::lua::event::CalculateMovementSpeed(mwse::lua::event::CalculateMovementSpeed::SwimRun, this, speed));
-		if (eventData.valid()) {
-			speed = eventData["speed"];
+		if (mwse::lua::event::CalculateMovementSpeed::getEventEnabled(mwse::lua::event::CalculateMovementSpeed::SwimRun)) {
+			mwse::lua::LuaManager& luaManager = mwse::lua::LuaManager::getInstance();
+			sol::table eventData = luaManager.triggerEvent(new mwse::lua::event::CalculateMovementSpeed(mwse::lua::event::CalculateMovementSpeed::SwimRun, this, speed));
+			if (eventData.valid()) {
+				speed = eventData["speed"];
+			}
 		}
 
 		return speed;
@@ -219,10 +227,12 @@ namespace TES3 {
 		float speed = reinterpret_cast<float(__thiscall *)(MobileActor*)>(TES3_MobileActor_calculateFlySpeed)(this);
 
 		// Launch our event, and overwrite the speed with what was given back to us.
-		mwse::lua::LuaManager& luaManager = mwse::lua::LuaManager::getInstance();
-		sol::table eventData = luaManager.triggerEvent(new mwse::lua::event::CalculateMovementSpeed(mwse::lua::event::CalculateMovementSpeed::Fly, this, speed));
-		if (eventData.valid()) {
-			speed = eventData["speed"];
+		if (mwse::lua::event::CalculateMovementSpeed::getEventEnabled(mwse::lua::event::CalculateMovementSpeed::Fly)) {
+			mwse::lua::LuaManager& luaManager = mwse::lua::LuaManager::getInstance();
+			sol::table eventData = luaManager.triggerEvent(new mwse::lua::event::CalculateMovementSpeed(mwse::lua::event::CalculateMovementSpeed::Fly, this, speed));
+			if (eventData.valid()) {
+				speed = eventData["speed"];
+			}
 		}
 
 		return speed;
@@ -1,5 +1,7 @@
 #include "TES3Object.h"
 
+#include "ObjectIdIndex.h"
+
 #include "TES3Actor.h"
 #include "TES3Reference.h"
 
@@ -42,6 +44,8 @@ namespace TES3 {
 	}
 
 	void Object::setID(const char* id) {
+		// Don't let the old ID find this object anymore.
+		mwse::tes3::ObjectIdIndex::getInstance().onObjectRemoved(this);
 		vTable.object->setID(this, id);
 	}
 
@@ -6,6 +6,7 @@
 #include "LuaActivateEvent.h"
 
 #include "TES3Util.h"
+#include "ReferenceSpatialIndex.h"
 
 #include "NINode.h"
 
@@ -156,6 +157,9 @@ namespace TES3 {
 		}
 
 		setObjectModified(true);
+
+		// Keep proximity queries accurate without waiting for the next frame.
+		mwse::tes3::ReferenceSpatialIndex::getInstance().onReferenceMoved(this);
 	}
 
 	void Reference::setPosition(Vector3* positionVec) {
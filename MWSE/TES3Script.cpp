@@ -1,5 +1,7 @@
 #include "TES3Script.h"
 
+#include "ObjectIdIndex.h"
+
 #define TES3_Script_getScriptParams 0x500510
 #define TES3_Script_executeScriptOpCode 0x505770
 
@@ -19,7 +21,16 @@ namespace TES3 {
 	}
 
 	char Script::getLocalVarIndexAndType(const char* name, unsigned int* out_value) {
-		return reinterpret_cast<char(__thiscall *)(Script*, const char*, unsigned int*)>(TES3_Script_getLocalVarIndexAndType)(this, name, out_value);
+		auto& index = mwse::tes3::ObjectIdIndex::getInstance();
+		char type = index.findLocalVariable(this, name, out_value);
+		if (type == 0) {
+			type = reinterpret_cast<char(__thiscall *)(Script*, const char*, unsigned int*)>(TES3_Script_getLocalVarIndexAndType)(this, name, out_value);
+			// The index is only written when the variable is found.
+			if (type != 0) {
+				index.cacheLocalVariable(this, name, type, *out_value);
+			}
+		}
+		return type;
 	}
 
 	short Script::getShortValue(unsigned int index, bool useLocalVars) {
@@ -1,6 +1,8 @@
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "LuaUtil.h"
 #include "TES3UIElement.h"
@@ -79,6 +81,721 @@ namespace mwse {
 			addPropertyToTable(table, node->branchGreaterThanOrEqual);
 		}
 
+		// Field setters, shared by the element usertype and templates.
+
+		static void setBorderAllSides(Element& self, sol::optional<int> value) {
+			self.borderAllSides = value.value_or(0);
+		}
+
+		static void setBorderLeft(Element& self, sol::optional<int> value) {
+			self.borderLeft = value.value_or(-1);
+		}
+
+		static void setBorderRight(Element& self, sol::optional<int> value) {
+			self.borderRight = value.value_or(-1);
+		}
+
+		static void setBorderBottom(Element& self, sol::optional<int> value) {
+			self.borderBottom = value.value_or(-1);
+		}
+
+		static void setBorderTop(Element& self, sol::optional<int> value) {
+			self.borderTop = value.value_or(-1);
+		}
+
+		static void setPaddingAllSides(Element& self, sol::optional<int> value) {
+			self.paddingAllSides = value.value_or(0);
+		}
+
+		static void setPaddingLeft(Element& self, sol::optional<int> value) {
+			self.paddingLeft = value.value_or(-1);
+		}
+
+		static void setPaddingRight(Element& self, sol::optional<int> value) {
+			self.paddingRight = value.value_or(-1);
+		}
+
+		static void setPaddingBottom(Element& self, sol::optional<int> value) {
+			self.paddingBottom = value.value_or(-1);
+		}
+
+		static void setPaddingTop(Element& self, sol::optional<int> value) {
+			self.paddingTop = value.value_or(-1);
+		}
+
+		static void setFont(Element& self, sol::optional<int> value) {
+			self.setProperty(TES3::UI::Property::font, value.value_or(0));
+		}
+
+		static void setPositionX(Element& self, int value) {
+			self.setProperty(TES3::UI::Property::x_loc, value);
+		}
+
+		static void setPositionY(Element& self, int value) {
+			self.setProperty(TES3::UI::Property::y_loc, value);
+		}
+
+		static void setVisible(Element& self, sol::optional<bool> value) {
+			self.setVisible(value.value_or(true));
+		}
+
+		static void setConsumeMouseEvents(Element& self, sol::optional<bool> value) {
+			self.flagConsumeMouseEvents = value.value_or(true);
+		}
+
+		static void setWidth(Element& self, int value) {
+			self.setProperty(TES3::UI::Property::width, value);
+		}
+
+		static void setHeight(Element& self, int value) {
+			self.setProperty(TES3::UI::Property::height, value);
+		}
+
+		static void setMinWidth(Element& self, sol::optional<int> value) {
+			self.setProperty(TES3::UI::Property::min_width, value.value_or(INT32_MIN));
+		}
+
+		static void setMinHeight(Element& self, sol::optional<int> value) {
+			self.setProperty(TES3::UI::Property::min_height, value.value_or(INT32_MIN));
+		}
+
+		static void setMaxWidth(Element& self, sol::optional<int> value) {
+			self.setProperty(TES3::UI::Property::max_width, value.value_or(INT32_MAX));
+		}
+
+		static void setMaxHeight(Element& self, sol::optional<int> value) {
+			self.setProperty(TES3::UI::Property::max_height, value.value_or(INT32_MAX));
+		}
+
+		static void setAutoWidth(Element& self, bool value) {
+			self.setAutoWidth(value);
+		}
+
+		static void setAutoHeight(Element& self, bool value) {
+			self.setAutoHeight(value);
+		}
+
+		static void setWidthProportional(Element& self, sol::optional<double> value) {
+			self.widthProportional = value.value_or(-1.0);
+		}
+
+		static void setHeightProportional(Element& self, sol::optional<double> value) {
+			self.heightProportional = value.value_or(-1.0);
+		}
+
+		static void setAbsolutePosAlignX(Element& self, sol::optional<double> value) {
+			self.absolutePosAlignX = value.value_or(-1.0);
+		}
+
+		static void setAbsolutePosAlignY(Element& self, sol::optional<double> value) {
+			self.absolutePosAlignY = value.value_or(-1.0);
+		}
+
+		static void setColor(Element& self, sol::table c) {
+			self.colourRed = c[1];
+			self.colourGreen = c[2];
+			self.colourBlue = c[3];
+			self.flagUsesRGBA = 1;
+		}
+
+		static void setAlpha(Element& self, float value) {
+			self.colourAlpha = value;
+			self.flagUsesRGBA = 1;
+		}
+
+		static void setFlowDirection(Element& self, std::string value) {
+			auto prop = (value == "top_to_bottom") ? TES3::UI::Property::top_to_bottom : TES3::UI::Property::left_to_right;
+			self.setProperty(TES3::UI::Property::flow_direction, prop);
+		}
+
+		static void setChildAlignX(Element& self, float value) {
+			self.setProperty(TES3::UI::Property::align_x, value);
+		}
+
+		static void setChildAlignY(Element& self, float value) {
+			self.setProperty(TES3::UI::Property::align_y, value);
+		}
+
+		static void setChildOffsetX(Element& self, sol::optional<int> value) {
+			self.setProperty(TES3::UI::Property::child_offset_x, value.value_or(INT32_MAX));
+		}
+
+		static void setChildOffsetY(Element& self, sol::optional<int> value) {
+			self.setProperty(TES3::UI::Property::child_offset_y, value.value_or(INT32_MAX));
+		}
+
+		static void setWrapText(Element& self, bool value) {
+			self.setProperty(TES3::UI::Property::wrap_text, toBooleanProperty(value));
+			self.flagContentChanged = 1;
+		}
+
+		static void setJustifyText(Element& self, std::string value) {
+			auto prop = TES3::UI::Property::left;
+			if (value == "center") {
+				prop = TES3::UI::Property::center;
+			}
+			else if (value == "right") {
+				prop = TES3::UI::Property::right;
+			}
+			self.setProperty(TES3::UI::Property::justify, prop);
+			self.flagContentChanged = 1;
+		}
+
+		static void setNodeOffsetX(Element& self, int value) {
+			self.setProperty(TES3::UI::Property::node_offset_x, value);
+		}
+
+		static void setNodeOffsetY(Element& self, int value) {
+			self.setProperty(TES3::UI::Property::node_offset_y, value);
+		}
+
+		static void setDisabled(Element& self, bool value) {
+			self.setProperty(TES3::UI::Property::disabled, toBooleanProperty(value));
+		}
+
+		static void setScaleMode(Element& self, bool value) {
+			self.scale_mode = toBooleanProperty(value);
+			self.flagContentChanged = 1;
+		}
+
+		static void setImageScaleX(Element& self, float value) {
+			self.imageScaleX = value;
+			self.flagContentChanged = 1;
+		}
+
+		static void setImageScaleY(Element& self, float value) {
+			self.imageScaleY = value;
+			self.flagContentChanged = 1;
+		}
+
+		static void setRepeatKeys(Element& self, bool value) {
+			self.setProperty(TES3::UI::Property::repeat_keys, toBooleanProperty(value));
+		}
+
+		static void setContentPath(Element& self, sol::optional<const char*> path) {
+			self.setIcon(path.value_or(""));
+		}
+
+		// Registers a lua callback, or the address of a native one, for a UI event by name.
+		static void registerEvent(Element& self, const std::string& eventID, sol::object callback) {
+			// Callback is supposed to be an address. Dangerous advanced usage, sets the actual property.
+			if (callback.is<unsigned int>()) {
+				// Map friendlier event names to standard UI events1
+				auto it = standardNamedEvents.find(eventID);
+				if (it != standardNamedEvents.end()) {
+					self.setProperty(it->second, reinterpret_cast<TES3::UI::EventCallback>(callback.as<unsigned int>()));
+					return;
+				}
+
+				// Check UI registry for custom event
+				TES3::UI::Property prop = getCachedProperty(eventID);
+				self.setProperty(prop, reinterpret_cast<TES3::UI::EventCallback>(callback.as<unsigned int>()));
+			}
+
+			// Callback is a lua event, put it into our custom handler system.
+			else if (callback.is<sol::protected_function>()) {
+				if (!callback.valid()) {
+					const char *errorSource = self.name.cString ? self.name.cString : "(unnamed)";
+					log::getLog() << "UI register event has invalid callback: target " << errorSource << ", event " << eventID << std::endl;
+					return;
+				}
+
+				// Map friendlier event names to standard UI events
+				auto it = standardNamedEvents.find(eventID);
+				if (it != standardNamedEvents.end()) {
+					registerUIEvent(self, it->second, callback);
+					return;
+				}
+
+				// Check UI registry for custom event
+				TES3::UI::Property prop = getCachedProperty(eventID);
+				registerUIEvent(self, prop, callback.as<sol::protected_function>());
+			}
+			
+			// Unrecognized type, spit an error.
+			else {
+				const char *errorSource = self.name.cString ? self.name.cString : "(unnamed)";
+				log::getLog() << "UI register event has invalid callback type: target " << errorSource << ", event " << eventID << std::endl;
+			}
+		}
+
+		// Element creation functions, shared by the element usertype and templates.
+
+		static Element* createBlock(Element& self, sol::optional<sol::table> args) {
+			if (args) {
+				return self.createBlock(args.value().get_or("id", idNull));
+			}
+			else {
+				return self.createBlock(idNull);
+			}
+		}
+
+		static Element* createButton(Element& self, sol::optional<sol::table> args) {
+			Element * button = nullptr;
+			if (args) {
+				button = self.createButton(args.value().get_or("id", idNull));
+
+				auto text = args.value().get<sol::optional<const char*>>("text");
+				if (text) {
+					button->setText(text.value());
+				}
+			}
+			else {
+				button = self.createButton(idNull);
+			}
+
+			return button;
+		}
+
+		static Element* createDivider(Element& self, sol::optional<sol::table> args) {
+			Element * image = nullptr;
+			if (args) {
+				image = self.createImage(args.value().get_or("id", idNull), "Textures\\menu_divider.tga");
+			}
+			else {
+				image = self.createImage(idNull, "Textures\\menu_divider.tga");
+			}
+			image->borderAllSides = 8;
+			image->widthProportional = 1.0;
+			image->flagExtendImageToBounds = 1;
+			return image;
+		}
+
+		static Element* createFillBar(Element& self, sol::optional<sol::table> args) {
+			Element * element = nullptr;
+			if (args) {
+				element = self.createFillBar(args.value().get_or("id", idNull));
+				auto fillbar = TES3::UI::WidgetFillbar::fromElement(element);
+				fillbar->setCurrent(args.value().get_or("current", 0));
+				fillbar->setMax(args.value().get_or("max", 0));
+			}
+			else {
+				element = self.createFillBar(idNull);
+				auto fillbar = TES3::UI::WidgetFillbar::fromElement(element);
+				fillbar->setCurrent(0);
+				fillbar->setMax(0);
+			}
+			return element;
+		}
+
+		static Element* createHorizontalScrollPane(Element& self, sol::optional<sol::table> args) {
+			Element * scrollpane = nullptr;
+			if (args) {
+				scrollpane = self.createHorizontalScrollPane(args.value().get_or("id", idNull));
+			}
+			else {
+				scrollpane = self.createHorizontalScrollPane(idNull);
+			}
+
+			// Add mouse wheel handlers (see event dispatch patch in TES3UIManager.cpp)
+			scrollpane->setProperty(TES3::UI::Property::event_mouse_scroll_down, TES3::UI::onScrollPaneMousewheel);
+			scrollpane->setProperty(TES3::UI::Property::event_mouse_scroll_up, TES3::UI::onScrollPaneMousewheel);
+			return scrollpane;
+		}
+
+		static Element* createHypertext(Element& self, sol::optional<sol::table> args) {
+			if (args) {
+				return self.createHypertext(args.value().get_or("id", idNull));
+			}
+			else {
+				return self.createHypertext(idNull);
+			}
+		}
+
+		static Element* createImage(Element& self, sol::table args) {
+			auto path = args.get<sol::optional<const char*>>("path");
+			if (path) {
+				std::string pathStr = path.value();
+				if (pathStr.find("/") != std::string::npos) {
+					std::replace(pathStr.begin(), pathStr.end(), '/', '\\');
+				}
+
+				return self.createImage(args.get_or("id", idNull), pathStr.c_str());
+			}
+			else {
+				log::getLog() << "createImage: path argument is required." << std::endl;
+			}
+			return static_cast<Element*>(nullptr);
+		}
+
+		static Element* createLabel(Element& self, sol::table args) {
+			auto text = args.get<sol::optional<const char*>>("text");
+			return self.createLabel(args.get_or("id", idNull), text.value_or("(nil)"));
+		}
+
+		static Element* createNif(Element& self, sol::table args) {
+			auto path = args.get<sol::optional<const char*>>("path");
+			if (path) {
+				std::string pathStr = path.value();
+				if (pathStr.find("/") != std::string::npos) {
+					std::replace(pathStr.begin(), pathStr.end(), '/', '\\');
+				}
+
+				return self.createNif(args.get_or("id", idNull), pathStr.c_str());
+			}
+			else {
+				log::getLog() << "createNif: path argument is required." << std::endl;
+			}
+			return static_cast<Element*>(nullptr);
+		}
+
+		static Element* createParagraphInput(Element& self, sol::optional<sol::table> args) {
+			if (args) {
+				return self.createParagraphInput(args.value().get_or("id", idNull));
+			}
+			else {
+				return self.createParagraphInput(idNull);
+			}
+		}
+
+		static Element* createRect(Element& self, sol::table args) {
+			Element* rect = self.createRect(args.get_or("id", idNull));
+			auto argColour = args.get<sol::optional<sol::table>>("color");
+			if (argColour) {
+				auto c = argColour.value();
+				self.colourRed = c[1];
+				self.colourGreen = c[2];
+				self.colourBlue = c[3];
+				self.flagUsesRGBA = 1;
+			}
+			return rect;
+		}
+
+		static Element* createSlider(Element& self, sol::table args) {
+			auto element = self.createSlider(args.get_or("id", idNull));
+			auto slider = TES3::UI::WidgetScrollBar::fromElement(element);
+			slider->setCurrent(args.get_or("current", 0));
+			slider->setMax(args.get_or("max", 0));
+			slider->setStepX(args.get_or("step", 1));
+			slider->setJumpX(args.get_or("jump", 5));
+			return element;
+		}
+
+		static Element* createSliderVertical(Element& self, sol::table args) {
+			auto element = self.createSliderVertical(args.get_or("id", idNull));
+			auto slider = TES3::UI::WidgetScrollBar::fromElement(element);
+			slider->setCurrent(args.get_or("current", 0));
+			slider->setMax(args.get_or("max", 0));
+			slider->setStepX(args.get_or("step", 1));
+			slider->setJumpX(args.get_or("jump", 5));
+			return element;
+		}
+
+		static Element* createTextInput(Element& self, sol::optional<sol::table> args) {
+			if (args) {
+				return self.createTextInput(args.value().get_or("id", idNull));
+			}
+			else {
+				return self.createTextInput(idNull);
+			}
+		}
+
+		static Element* createTextSelect(Element& self, sol::table args) {
+			auto element = self.createTextSelect(args.get_or("id", idNull));
+			auto text = args.get<sol::optional<const char*>>("text");
+			if (text) {
+				element->setText(text.value());
+			}
+			auto textSelect = TES3::UI::WidgetTextSelect::fromElement(element);
+			auto state = args.get<sol::optional<int>>("state");
+			if (state) {
+				textSelect->setState(state.value());
+			}
+			return element;
+		}
+
+		static Element* createThinBorder(Element& self, sol::optional<sol::table> args) {
+			if (args) {
+				return self.createNif(args.value().get_or("id", idNull), "menu_thin_border.nif");
+			}
+			else {
+				return self.createNif(idNull, "menu_thin_border.nif");
+			}
+		}
+
+		static Element* createVerticalScrollPane(Element& self, sol::table args) {
+			auto scrollpane = self.createVerticalScrollPane(args.get_or("id", idNull));
+
+			if (args.get_or("hideFrame", false)) {
+				scrollpane->setIcon("");
+			}
+
+			// Add mouse wheel handlers (see event dispatch patch in TES3UIManager.cpp)
+			scrollpane->setProperty(TES3::UI::Property::event_mouse_scroll_down, TES3::UI::onScrollPaneMousewheel);
+			scrollpane->setProperty(TES3::UI::Property::event_mouse_scroll_up, TES3::UI::onScrollPaneMousewheel);
+			return scrollpane;
+		}
+
+		//
+		// Building elements from templates.
+		//
+
+		typedef void (*TemplateFieldSetter)(Element& element, lua_State* L, int index);
+
+		template <typename T, void (*Set)(Element&, T)>
+		static void setTemplateField(Element& element, lua_State* L, int index) {
+			Set(element, sol::stack::get<T>(L, index));
+		}
+
+		// Element fields that templates set directly. Other keys go through the element usertype.
+		const std::unordered_map<std::string, TemplateFieldSetter> templateFieldSetters = {
+			{ "borderAllSides", setTemplateField<sol::optional<int>, setBorderAllSides> },
+			{ "borderLeft", setTemplateField<sol::optional<int>, setBorderLeft> },
+			{ "borderRight", setTemplateField<sol::optional<int>, setBorderRight> },
+			{ "borderBottom", setTemplateField<sol::optional<int>, setBorderBottom> },
+			{ "borderTop", setTemplateField<sol::optional<int>, setBorderTop> },
+			{ "paddingAllSides", setTemplateField<sol::optional<int>, setPaddingAllSides> },
+			{ "paddingLeft", setTemplateField<sol::optional<int>, setPaddingLeft> },
+			{ "paddingRight", setTemplateField<sol::optional<int>, setPaddingRight> },
+			{ "paddingBottom", setTemplateField<sol::optional<int>, setPaddingBottom> },
+			{ "paddingTop", setTemplateField<sol::optional<int>, setPaddingTop> },
+			{ "font", setTemplateField<sol::optional<int>, setFont> },
+			{ "positionX", setTemplateField<int, setPositionX> },
+			{ "positionY", setTemplateField<int, setPositionY> },
+			{ "visible", setTemplateField<sol::optional<bool>, setVisible> },
+			{ "consumeMouseEvents", setTemplateField<sol::optional<bool>, setConsumeMouseEvents> },
+			{ "width", setTemplateField<int, setWidth> },
+			{ "height", setTemplateField<int, setHeight> },
+			{ "minWidth", setTemplateField<sol::optional<int>, setMinWidth> },
+			{ "minHeight", setTemplateField<sol::optional<int>, setMinHeight> },
+			{ "maxWidth", setTemplateField<sol::optional<int>, setMaxWidth> },
+			{ "maxHeight", setTemplateField<sol::optional<int>, setMaxHeight> },
+			{ "autoWidth", setTemplateField<bool, setAutoWidth> },
+			{ "autoHeight", setTemplateField<bool, setAutoHeight> },
+			{ "widthProportional", setTemplateField<sol::optional<double>, setWidthProportional> },
+			{ "heightProportional", setTemplateField<sol::optional<double>, setHeightProportional> },
+			{ "absolutePosAlignX", setTemplateField<sol::optional<double>, setAbsolutePosAlignX> },
+			{ "absolutePosAlignY", setTemplateField<sol::optional<double>, setAbsolutePosAlignY> },
+			{ "color", setTemplateField<sol::table, setColor> },
+			{ "alpha", setTemplateField<float, setAlpha> },
+			{ "flowDirection", setTemplateField<std::string, setFlowDirection> },
+			{ "childAlignX", setTemplateField<float, setChildAlignX> },
+			{ "childAlignY", setTemplateField<float, setChildAlignY> },
+			{ "childOffsetX", setTemplateField<sol::optional<int>, setChildOffsetX> },
+			{ "childOffsetY", setTemplateField<sol::optional<int>, setChildOffsetY> },
+			{ "wrapText", setTemplateField<bool, setWrapText> },
+			{ "justifyText", setTemplateField<std::string, setJustifyText> },
+			{ "nodeOffsetX", setTemplateField<int, setNodeOffsetX> },
+			{ "nodeOffsetY", setTemplateField<int, setNodeOffsetY> },
+			{ "disabled", setTemplateField<bool, setDisabled> },
+			{ "scaleMode", setTemplateField<bool, setScaleMode> },
+			{ "imageScaleX", setTemplateField<float, setImageScaleX> },
+			{ "imageScaleY", setTemplateField<float, setImageScaleY> },
+			{ "repeatKeys", setTemplateField<bool, setRepeatKeys> },
+			{ "contentPath", setTemplateField<sol::optional<const char*>, setContentPath> },
+			{ "text", setTemplateField<const char*, setWidgetText> },
+		};
+
+		// Keys with special meaning in every template, which aren't element fields.
+		const char* const templateReservedKeys[] = { "type", "id", "ref", "children", "events", "widget" };
+
+		struct TemplateElementType {
+			Element* (*create)(Element& parent, sol::table args);
+
+			// Template keys used by the create function, which shouldn't also be set as element fields.
+			std::vector<const char*> arguments;
+		};
+
+		const std::unordered_map<std::string, TemplateElementType> templateElementTypes = {
+			{ "block", { [](Element& parent, sol::table args) { return createBlock(parent, args); }, {} } },
+			{ "button", { [](Element& parent, sol::table args) { return createButton(parent, args); }, { "text" } } },
+			{ "divider", { [](Element& parent, sol::table args) { return createDivider(parent, args); }, {} } },
+			{ "fillBar", { [](Element& parent, sol::table args) { return createFillBar(parent, args); }, { "current", "max" } } },
+			{ "horizontalScrollPane", { [](Element& parent, sol::table args) { return createHorizontalScrollPane(parent, args); }, {} } },
+			{ "hypertext", { [](Element& parent, sol::table args) { return createHypertext(parent, args); }, {} } },
+			{ "image", { createImage, { "path" } } },
+			{ "label", { createLabel, { "text" } } },
+			{ "nif", { createNif, { "path" } } },
+			{ "paragraphInput", { [](Element& parent, sol::table args) { return createParagraphInput(parent, args); }, {} } },
+			{ "rect", { createRect, { "color" } } },
+			{ "slider", { createSlider, { "current", "max", "step", "jump" } } },
+			{ "sliderVertical", { createSliderVertical, { "current", "max", "step", "jump" } } },
+			{ "textInput", { [](Element& parent, sol::table args) { return createTextInput(parent, args); }, {} } },
+			{ "textSelect", { createTextSelect, { "text", "state" } } },
+			{ "thinBorder", { [](Element& parent, sol::table args) { return createThinBorder(parent, args); }, {} } },
+			{ "verticalScrollPane", { createVerticalScrollPane, { "hideFrame" } } },
+			{ "virtualList", { createVirtualList, { "rowCount", "rowHeight", "populate" } } },
+		};
+
+		// Builds element trees from template tables, working on the lua stack directly. Element types
+		// and template keys are resolved once per build.
+		class ElementTemplateBuilder {
+		public:
+			ElementTemplateBuilder(lua_State* L) :
+				m_L(L),
+				m_Refs(LuaManager::getInstance().createTable())
+			{
+
+			}
+
+			// Builds the template at the given absolute stack index.
+			Element* build(Element& parent, int index) {
+				if (!lua_checkstack(m_L, 8)) {
+					throw std::invalid_argument("createFromTemplate: Template is nested too deeply.");
+				}
+
+				const TemplateElementType& type = resolveType(index);
+				Element* element = type.create(parent, sol::table(m_L, index));
+				if (element == nullptr) {
+					return nullptr;
+				}
+
+				setFields(*element, type, index);
+
+				lua_getfield(m_L, index, "widget");
+				if (lua_istable(m_L, -1)) {
+					sol::object widget = makeWidget(*element);
+					if (widget != sol::nil) {
+						sol::table widgetValues(m_L, -1);
+						sol::userdata widgetObject = widget;
+						for (const auto& entry : widgetValues) {
+							widgetObject[entry.first] = entry.second;
+						}
+					}
+				}
+				lua_pop(m_L, 1);
+
+				lua_getfield(m_L, index, "events");
+				if (lua_istable(m_L, -1)) {
+					int events = lua_gettop(m_L);
+					lua_pushnil(m_L);
+					while (lua_next(m_L, events) != 0) {
+						if (lua_type(m_L, -2) == LUA_TSTRING) {
+							registerEvent(*element, lua_tostring(m_L, -2), sol::object(m_L, -1));
+						}
+						lua_pop(m_L, 1);
+					}
+				}
+				lua_pop(m_L, 1);
+
+				lua_getfield(m_L, index, "ref");
+				if (lua_type(m_L, -1) == LUA_TSTRING) {
+					m_Refs[lua_tostring(m_L, -1)] = element;
+				}
+				lua_pop(m_L, 1);
+
+				lua_getfield(m_L, index, "children");
+				if (lua_istable(m_L, -1)) {
+					int children = lua_gettop(m_L);
+					for (size_t i = 1, count = lua_objlen(m_L, children); i <= count; i++) {
+						lua_rawgeti(m_L, children, int(i));
+						if (lua_istable(m_L, -1)) {
+							build(*element, lua_gettop(m_L));
+						}
+						lua_pop(m_L, 1);
+					}
+				}
+				lua_pop(m_L, 1);
+
+				return element;
+			}
+
+			sol::table getRefs() {
+				return m_Refs;
+			}
+
+		private:
+			enum class KeyType {
+				Reserved,
+				Setter,
+				Usertype
+			};
+
+			struct ResolvedKey {
+				KeyType type;
+				TemplateFieldSetter setter;
+			};
+
+			const TemplateElementType& resolveType(int index) {
+				lua_getfield(m_L, index, "type");
+				int valueType = lua_type(m_L, -1);
+				const char* name = valueType == LUA_TSTRING ? lua_tostring(m_L, -1) : nullptr;
+				lua_pop(m_L, 1);
+
+				if (valueType != LUA_TSTRING && valueType != LUA_TNIL) {
+					throw std::invalid_argument("createFromTemplate: Element type must be a string.");
+				}
+
+				auto cached = m_Types.find(name);
+				if (cached != m_Types.end()) {
+					return *cached->second;
+				}
+
+				auto result = templateElementTypes.find(name ? name : "block");
+				if (result == templateElementTypes.end()) {
+					throw std::invalid_argument(std::string("createFromTemplate: Unknown element type '") + name + "'.");
+				}
+
+				m_Types[name] = &result->second;
+				return result->second;
+			}
+
+			const ResolvedKey& resolveKey(const char* key) {
+				auto cached = m_Keys.find(key);
+				if (cached != m_Keys.end()) {
+					return cached->second;
+				}
+
+				ResolvedKey resolved = { KeyType::Usertype, nullptr };
+				for (const char* reserved : templateReservedKeys) {
+					if (strcmp(key, reserved) == 0) {
+						resolved.type = KeyType::Reserved;
+						break;
+					}
+				}
+
+				if (resolved.type != KeyType::Reserved) {
+					auto setter = templateFieldSetters.find(key);
+					if (setter != templateFieldSetters.end()) {
+						resolved = { KeyType::Setter, setter->second };
+					}
+				}
+
+				return m_Keys.emplace(key, resolved).first->second;
+			}
+
+			void setFields(Element& element, const TemplateElementType& type, int index) {
+				lua_pushnil(m_L);
+				while (lua_next(m_L, index) != 0) {
+					if (lua_type(m_L, -2) == LUA_TSTRING) {
+						const char* key = lua_tostring(m_L, -2);
+						const ResolvedKey& resolved = resolveKey(key);
+						if (resolved.type != KeyType::Reserved && !isArgument(type, key)) {
+							if (resolved.type == KeyType::Setter) {
+								resolved.setter(element, m_L, lua_gettop(m_L));
+							}
+							else {
+								// Anything else is assigned through the usertype, as if it were set from lua.
+								sol::stack::push(m_L, &element);
+								lua_pushvalue(m_L, -3);
+								lua_pushvalue(m_L, -3);
+								lua_settable(m_L, -3);
+								lua_pop(m_L, 1);
+							}
+						}
+					}
+					lua_pop(m_L, 1);
+				}
+			}
+
+			static bool isArgument(const TemplateElementType& type, const char* key) {
+				for (const char* argument : type.arguments) {
+					if (strcmp(key, argument) == 0) {
+						return true;
+					}
+				}
+				return false;
+			}
+
+			lua_State* m_L;
+			sol::table m_Refs;
+
+			// Lua interns strings, and the template keeps them alive for the whole build, so the same
+			// key or type name always has the same address.
+			std::unordered_map<const char*, ResolvedKey> m_Keys;
+			std::unordered_map<const char*, const TemplateElementType*> m_Types;
+		};
+
 		void bindTES3UIElement() {
 			// Get our lua state.
 			sol::state& state = LuaManager::getInstance().getState();
@@ -119,63 +836,63 @@ namespace mwse {
 			// Many properties also set lazy-update flags through setProperty.
 			usertypeDefinition.set("borderAllSides", sol::property(
 				[](Element& self) { return self.borderAllSides; },
-				[](Element& self, sol::optional<int> value) { self.borderAllSides = value.value_or(0); }
+				setBorderAllSides
 			));
 			usertypeDefinition.set("borderLeft", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.borderLeft, -1); },
-				[](Element& self, sol::optional<int> value) { self.borderLeft = value.value_or(-1); }
+				setBorderLeft
 			));
 			usertypeDefinition.set("borderRight", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.borderRight, -1); },
-				[](Element& self, sol::optional<int> value) { self.borderRight = value.value_or(-1); }
+				setBorderRight
 			));
 			usertypeDefinition.set("borderBottom", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.borderBottom, -1); },
-				[](Element& self, sol::optional<int> value) { self.borderBottom = value.value_or(-1); }
+				setBorderBottom
 			));
 			usertypeDefinition.set("borderTop", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.borderTop, -1); },
-				[](Element& self, sol::optional<int> value) { self.borderTop = value.value_or(-1); }
+				setBorderTop
 			));
 			usertypeDefinition.set("paddingAllSides", sol::property(
 				[](Element& self) { return self.paddingAllSides; },
-				[](Element& self, sol::optional<int> value) { self.paddingAllSides = value.value_or(0); }
+				setPaddingAllSides
 			));
 			usertypeDefinition.set("paddingLeft", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.paddingLeft, -1); },
-				[](Element& self, sol::optional<int> value) { self.paddingLeft = value.value_or(-1); }
+				setPaddingLeft
 			));
 			usertypeDefinition.set("paddingRight", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.paddingRight, -1); },
-				[](Element& self, sol::optional<int> value) { self.paddingRight = value.value_or(-1); }
+				setPaddingRight
 			));
 			usertypeDefinition.set("paddingBottom", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.paddingBottom, -1); },
-				[](Element& self, sol::optional<int> value) { self.paddingBottom = value.value_or(-1); }
+				setPaddingBottom
 			));
 			usertypeDefinition.set("paddingTop", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.paddingTop, -1); },
-				[](Element& self, sol::optional<int> value) { self.paddingTop = value.value_or(-1); }
+				setPaddingTop
 			));
 			usertypeDefinition.set("font", sol::property(
 				[](Element& self) { return self.font; },
-				[](Element& self, sol::optional<int> value) { self.setProperty(TES3::UI::Property::font, value.value_or(0)); }
+				setFont
 			));
 			usertypeDefinition.set("positionX", sol::property(
 				[](Element& self) { return self.positionX; },
-				[](Element& self, int value) { self.setProperty(TES3::UI::Property::x_loc, value); }
+				setPositionX
 			));
 			usertypeDefinition.set("positionY", sol::property(
 				[](Element& self) { return self.positionY; },
-				[](Element& self, int value) { self.setProperty(TES3::UI::Property::y_loc, value); }
+				setPositionY
 			));
 			usertypeDefinition.set("visible", sol::property(
 				[](Element& self) { return self.visible != 0; },
-				[](Element& self, sol::optional<bool> value) { self.setVisible(value.value_or(true)); }
+				setVisible
 			));
 			usertypeDefinition.set("consumeMouseEvents", sol::property(
 				[](Element& self) { return self.flagConsumeMouseEvents != 0; },
-				[](Element& self, sol::optional<bool> value) { self.flagConsumeMouseEvents = value.value_or(true); }
+				setConsumeMouseEvents
 			));
 			usertypeDefinition.set("nodeMinX", &Element::nodeMinX);
 			usertypeDefinition.set("nodeMaxX", &Element::nodeMaxX);
@@ -183,106 +900,92 @@ namespace mwse {
 			usertypeDefinition.set("nodeMaxY", &Element::nodeMaxY);
 			usertypeDefinition.set("width", sol::property(
 				[](Element& self) { return self.width; },
-				[](Element& self, int value) { self.setProperty(TES3::UI::Property::width, value); }
+				setWidth
 			));
 			usertypeDefinition.set("height", sol::property(
 				[](Element& self) { return self.height; },
-				[](Element& self, int value) { self.setProperty(TES3::UI::Property::height, value); }
+				setHeight
 			));
 			usertypeDefinition.set("minWidth", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.minWidth, INT32_MIN); },
-				[](Element& self, sol::optional<int> value) { self.setProperty(TES3::UI::Property::min_width, value.value_or(INT32_MIN)); }
+				setMinWidth
 			));
 			usertypeDefinition.set("minHeight", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.minHeight, INT32_MIN); },
-				[](Element& self, sol::optional<int> value) { self.setProperty(TES3::UI::Property::min_height, value.value_or(INT32_MIN)); }
+				setMinHeight
 			));
 			usertypeDefinition.set("maxWidth", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.maxWidth, INT32_MAX); },
-				[](Element& self, sol::optional<int> value) { self.setProperty(TES3::UI::Property::max_width, value.value_or(INT32_MAX)); }
+				setMaxWidth
 			));
 			usertypeDefinition.set("maxHeight", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.maxHeight, INT32_MAX); },
-				[](Element& self, sol::optional<int> value) { self.setProperty(TES3::UI::Property::max_height, value.value_or(INT32_MAX)); }
+				setMaxHeight
 			));
 			usertypeDefinition.set("autoWidth", sol::property(
 				[](Element& self) { return self.flagAutoWidth != 0; },
-				[](Element& self, bool value) { self.setAutoWidth(value); }
+				setAutoWidth
 			));
 			usertypeDefinition.set("autoHeight", sol::property(
 				[](Element& self) { return self.flagAutoHeight != 0; },
-				[](Element& self, bool value) { self.setAutoHeight(value); }
+				setAutoHeight
 			));
 			usertypeDefinition.set("widthProportional", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.widthProportional, -1.0f); },
-				[](Element& self, sol::optional<double> value) { self.widthProportional = value.value_or(-1.0); }
+				setWidthProportional
 			));
 			usertypeDefinition.set("heightProportional", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.heightProportional, -1.0f); },
-				[](Element& self, sol::optional<double> value) { self.heightProportional = value.value_or(-1.0); }
+				setHeightProportional
 			));
 			usertypeDefinition.set("absolutePosAlignX", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.absolutePosAlignX, -1.0f); },
-				[](Element& self, sol::optional<double> value) { self.absolutePosAlignX = value.value_or(-1.0); }
+				setAbsolutePosAlignX
 			));
 			usertypeDefinition.set("absolutePosAlignY", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.absolutePosAlignY, -1.0f); },
-				[](Element& self, sol::optional<double> value) { self.absolutePosAlignY = value.value_or(-1.0); }
+				setAbsolutePosAlignY
 			));
 			usertypeDefinition.set("color", sol::property(
 				[](Element& self) {
 					sol::state& state = LuaManager::getInstance().getState();
 					return state.create_table_with(1, self.colourRed, 2, self.colourGreen, 3, self.colourBlue);
 				},
-				[](Element& self, sol::table c) {
-					self.colourRed = c[1];
-					self.colourGreen = c[2];
-					self.colourBlue = c[3];
-					self.flagUsesRGBA = 1;
-				}
+				setColor
 			));
 			usertypeDefinition.set("alpha", sol::property(
 				[](Element& self) { return self.colourAlpha; },
-				[](Element& self, float value) {
-					self.colourAlpha = value;
-					self.flagUsesRGBA = 1;
-				}
+				setAlpha
 			));
 			usertypeDefinition.set("flowDirection", sol::property(
 				[](Element& self) {
 					auto flow = self.getProperty(TES3::UI::PropertyType::Property, TES3::UI::Property::flow_direction).propertyValue;
 					return (flow == TES3::UI::Property::top_to_bottom) ? "top_to_bottom" : "left_to_right";
 				},
-				[](Element& self, std::string value) {
-					auto prop = (value == "top_to_bottom") ? TES3::UI::Property::top_to_bottom : TES3::UI::Property::left_to_right;
-					self.setProperty(TES3::UI::Property::flow_direction, prop);
-				}
+				setFlowDirection
 			));
 			usertypeDefinition.set("childAlignX", sol::property(
 				[](Element& self) { return self.getProperty(TES3::UI::PropertyType::Float, TES3::UI::Property::align_x).floatValue; },
-				[](Element& self, float value) { self.setProperty(TES3::UI::Property::align_x, value); }
+				setChildAlignX
 			));
 			usertypeDefinition.set("childAlignY", sol::property(
 				[](Element& self) { return self.getProperty(TES3::UI::PropertyType::Float, TES3::UI::Property::align_y).floatValue; },
-				[](Element& self, float value) { self.setProperty(TES3::UI::Property::align_y, value); }
+				setChildAlignY
 			));
 			usertypeDefinition.set("childOffsetX", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.childOffsetX, INT32_MAX); },
-				[](Element& self, sol::optional<int> value) { self.setProperty(TES3::UI::Property::child_offset_x, value.value_or(INT32_MAX)); }
+				setChildOffsetX
 			));
 			usertypeDefinition.set("childOffsetY", sol::property(
 				[](Element& self) { return valueDefaultAsNil(self.childOffsetY, INT32_MAX); },
-				[](Element& self, sol::optional<int> value) { self.setProperty(TES3::UI::Property::child_offset_y, value.value_or(INT32_MAX)); }
+				setChildOffsetY
 			));
 			usertypeDefinition.set("wrapText", sol::property(
 				[](Element& self) {
 					auto prop = self.getProperty(TES3::UI::PropertyType::Property, TES3::UI::Property::wrap_text);
 					return toBoolean(prop.propertyValue);
 				},
-				[](Element& self, bool value) {
-					self.setProperty(TES3::UI::Property::wrap_text, toBooleanProperty(value));
-					self.flagContentChanged = 1;
-				}
+				setWrapText
 			));
 			usertypeDefinition.set("justifyText", sol::property(
 				[](Element& self) {
@@ -292,62 +995,43 @@ namespace mwse {
 					if (justify == TES3::UI::Property::right) return "right";
 					return "left";
 				},
-				[](Element& self, const std::string& value) {
-					auto prop = TES3::UI::Property::left;
-					if (value == "center") {
-						prop = TES3::UI::Property::center;
-					}
-					else if (value == "right") {
-						prop = TES3::UI::Property::right;
-					}
-					self.setProperty(TES3::UI::Property::justify, prop);
-					self.flagContentChanged = 1;
-				}
+				setJustifyText
 			));
 			usertypeDefinition.set("nodeOffsetX", sol::property(
 				[](Element& self) { return self.nodeOffsetX; },
-				[](Element& self, int value) { self.setProperty(TES3::UI::Property::node_offset_x, value); }
+				setNodeOffsetX
 			));
 			usertypeDefinition.set("nodeOffsetY", sol::property(
 				[](Element& self) { return self.nodeOffsetY; },
-				[](Element& self, int value) { self.setProperty(TES3::UI::Property::node_offset_y, value); }
+				setNodeOffsetY
 			));
 			usertypeDefinition.set("disabled", sol::property(
 				[](Element& self) {
 					auto prop = self.getProperty(TES3::UI::PropertyType::Property, TES3::UI::Property::disabled);
 					return toBoolean(prop.propertyValue);
 				},
-				[](Element& self, bool value) { self.setProperty(TES3::UI::Property::disabled, toBooleanProperty(value)); }
+				setDisabled
 			));
 			usertypeDefinition.set("scaleMode", sol::property(
 				[](Element& self) {
 					return toBoolean(self.scale_mode);
 				},
-				[](Element& self, bool value) {
-					self.scale_mode = toBooleanProperty(value);
-					self.flagContentChanged = 1;
-				}
+				setScaleMode
 			));
 			usertypeDefinition.set("imageScaleX", sol::property(
 				[](Element& self) { return self.imageScaleX; },
-				[](Element& self, float value) {
-					self.imageScaleX = value;
-					self.flagContentChanged = 1;
-				}
+				setImageScaleX
 			));
 			usertypeDefinition.set("imageScaleY", sol::property(
 				[](Element& self) { return self.imageScaleY; },
-				[](Element& self, float value) {
-					self.imageScaleY = value;
-					self.flagContentChanged = 1;
-				}
+				setImageScaleY
 			));
 			usertypeDefinition.set("repeatKeys", sol::property(
 				[](Element& self) {
 					auto prop = self.getProperty(TES3::UI::PropertyType::Property, TES3::UI::Property::repeat_keys);
 					return toBoolean(prop.propertyValue);
 				},
-				[](Element& self, bool value) { self.setProperty(TES3::UI::Property::repeat_keys, toBooleanProperty(value)); }
+				setRepeatKeys
 			));
 			usertypeDefinition.set("text", sol::property(getWidgetText, setWidgetText));
 			usertypeDefinition.set("contentType", sol::readonly_property([](Element& self) {
@@ -366,7 +1050,7 @@ namespace mwse {
 			}));
 			usertypeDefinition.set("contentPath", sol::property(
 				[](Element& self) { return self.contentPath.cString; },
-				[](Element& self, sol::optional<const char*> path) { self.setIcon(path.value_or("")); }
+				setContentPath
 			));
 
 			// Deprecated properties.
@@ -402,27 +1086,27 @@ namespace mwse {
 
 			// Custom property accessor functions.
 			usertypeDefinition.set("getPropertyBool",
-				[](Element& self, const char* propertyName) {
-					TES3::UI::Property prop = TES3::UI::registerProperty(propertyName);
+				[](Element& self, sol::object propertyName) {
+					TES3::UI::Property prop = getPropertyFromLua(propertyName);
 					auto b = self.getProperty(TES3::UI::PropertyType::Property, prop).propertyValue;
 					return toBoolean(b);
 				}
 			);
 			usertypeDefinition.set("getPropertyFloat",
-				[](Element& self, const char* propertyName) {
-					TES3::UI::Property prop = TES3::UI::registerProperty(propertyName);
+				[](Element& self, sol::object propertyName) {
+					TES3::UI::Property prop = getPropertyFromLua(propertyName);
 					return self.getProperty(TES3::UI::PropertyType::Float, prop).floatValue;
 				}
 			);
 			usertypeDefinition.set("getPropertyInt",
-				[](Element& self, const char* propertyName) {
-					TES3::UI::Property prop = TES3::UI::registerProperty(propertyName);
+				[](Element& self, sol::object propertyName) {
+					TES3::UI::Property prop = getPropertyFromLua(propertyName);
 					return self.getProperty(TES3::UI::PropertyType::Integer, prop).integerValue;
 				}
 			);
 			usertypeDefinition.set("getPropertyObject",
-				[](sol::this_state state, Element& self, const char* propertyName, sol::optional<std::string> typeCast) -> sol::object {
-					TES3::UI::Property prop = TES3::UI::registerProperty(propertyName);
+				[](sol::this_state state, Element& self, sol::object propertyName, sol::optional<std::string> typeCast) -> sol::object {
+					TES3::UI::Property prop = getPropertyFromLua(propertyName);
 					auto ptr = self.getProperty(TES3::UI::PropertyType::Pointer, prop).ptrValue;
 
 					if (!ptr) {
@@ -458,72 +1142,32 @@ namespace mwse {
 				}
 			);
 			usertypeDefinition.set("setPropertyBool",
-				[](Element& self, const char* propertyName, bool value) {
-					TES3::UI::Property prop = TES3::UI::registerProperty(propertyName);
+				[](Element& self, sol::object propertyName, bool value) {
+					TES3::UI::Property prop = getPropertyFromLua(propertyName);
 					self.setProperty(prop, toBooleanProperty(value) );
 				}
 			);
 			usertypeDefinition.set("setPropertyFloat",
-				[](Element& self, const char* propertyName, float value) {
-					TES3::UI::Property prop = TES3::UI::registerProperty(propertyName);
+				[](Element& self, sol::object propertyName, float value) {
+					TES3::UI::Property prop = getPropertyFromLua(propertyName);
 					self.setProperty(prop, value);
 				}
 			);
 			usertypeDefinition.set("setPropertyInt",
-				[](Element& self, const char* propertyName, int value) {
-					TES3::UI::Property prop = TES3::UI::registerProperty(propertyName);
+				[](Element& self, sol::object propertyName, int value) {
+					TES3::UI::Property prop = getPropertyFromLua(propertyName);
 					self.setProperty(prop, value);
 				}
 			);
 			usertypeDefinition.set("setPropertyObject",
-				[](Element& self, const char* propertyName, TES3::BaseObject* value) {
-					TES3::UI::Property prop = TES3::UI::registerProperty(propertyName);
+				[](Element& self, sol::object propertyName, TES3::BaseObject* value) {
+					TES3::UI::Property prop = getPropertyFromLua(propertyName);
 					self.setProperty(prop, value);
 				}
 			);
 
 			// Event functions.
-			usertypeDefinition.set("register", [](Element& self, const std::string& eventID, sol::object callback) {
-				// Callback is supposed to be an address. Dangerous advanced usage, sets the actual property.
-				if (callback.is<unsigned int>()) {
-					// Map friendlier event names to standard UI events1
-					auto it = standardNamedEvents.find(eventID);
-					if (it != standardNamedEvents.end()) {
-						self.setProperty(it->second, reinterpret_cast<TES3::UI::EventCallback>(callback.as<unsigned int>()));
-						return;
-					}
-
-					// Check UI registry for custom event
-					TES3::UI::Property prop = TES3::UI::registerProperty(eventID.c_str());
-					self.setProperty(prop, reinterpret_cast<TES3::UI::EventCallback>(callback.as<unsigned int>()));
-				}
-
-				// Callback is a lua event, put it into our custom handler system.
-				else if (callback.is<sol::protected_function>()) {
-					if (!callback.valid()) {
-						const char *errorSource = self.name.cString ? self.name.cString : "(unnamed)";
-						log::getLog() << "UI register event has invalid callback: target " << errorSource << ", event " << eventID << std::endl;
-						return;
-					}
-
-					// Map friendlier event names to standard UI events
-					auto it = standardNamedEvents.find(eventID);
-					if (it != standardNamedEvents.end()) {
-						registerUIEvent(self, it->second, callback);
-						return;
-					}
-
-					// Check UI registry for custom event
-					TES3::UI::Property prop = TES3::UI::registerProperty(eventID.c_str());
-					registerUIEvent(self, prop, callback.as<sol::protected_function>());
-				}
-				
-				// Unrecognized type, spit an error.
-				else {
-					const char *errorSource = self.name.cString ? self.name.cString : "(unnamed)";
-					log::getLog() << "UI register event has invalid callback type: target " << errorSource << ", event " << eventID << std::endl;
-				}
-			});
+			usertypeDefinition.set("register", registerEvent);
 			usertypeDefinition.set("unregister",
 				[](Element& self, const std::string& eventID) {
 					// Map friendlier event names to standard UI events
@@ -534,7 +1178,7 @@ namespace mwse {
 					}
 
 					// Check UI registry for custom event
-					TES3::UI::Property prop = TES3::UI::registerProperty(eventID.c_str());
+					TES3::UI::Property prop = getCachedProperty(eventID);
 					unregisterUIEvent(self, prop);
 				}
 			);
@@ -562,7 +1206,7 @@ namespace mwse {
 					}
 
 					// Check UI registry for custom event
-					TES3::UI::Property prop = TES3::UI::registerProperty(eventID.c_str());
+					TES3::UI::Property prop = getCachedProperty(eventID);
 					triggerEvent(self, prop, 0, 0);
 				}
 			);
@@ -596,196 +1240,34 @@ namespace mwse {
 
 				return self.reorderChildren(indexInsertBefore, indexMoveFrom, count);
 			});
-			usertypeDefinition.set("updateLayout", [](Element& self) { self.performLayout(1); });
+			usertypeDefinition.set("updateLayout", [](Element& self) { requestLayout(self); });
 
 			// Creation/destruction functions.
-			usertypeDefinition.set("createBlock", [](Element& self, sol::optional<sol::table> args) {
-				if (args) {
-					return self.createBlock(args.value().get_or("id", idNull));
-				}
-				else {
-					return self.createBlock(idNull);
-				}
-			});
-			usertypeDefinition.set("createButton", [](Element& self, sol::optional<sol::table> args) {
-				Element * button = nullptr;
-				if (args) {
-					button = self.createButton(args.value().get_or("id", idNull));
-
-					auto text = args.value().get<sol::optional<const char*>>("text");
-					if (text) {
-						button->setText(text.value());
-					}
-				}
-				else {
-					button = self.createButton(idNull);
-				}
-
-				return button;
-			});
-			usertypeDefinition.set("createDivider", [](Element& self, sol::optional<sol::table> args) {
-				Element * image = nullptr;
-				if (args) {
-					image = self.createImage(args.value().get_or("id", idNull), "Textures\\menu_divider.tga");
-				}
-				else {
-					image = self.createImage(idNull, "Textures\\menu_divider.tga");
-				}
-				image->borderAllSides = 8;
-				image->widthProportional = 1.0;
-				image->flagExtendImageToBounds = 1;
-				return image;
-			});
-			usertypeDefinition.set("createFillBar", [](Element& self, sol::optional<sol::table> args) {
-				Element * element = nullptr;
-				if (args) {
-					element = self.createFillBar(args.value().get_or("id", idNull));
-					auto fillbar = TES3::UI::WidgetFillbar::fromElement(element);
-					fillbar->setCurrent(args.value().get_or("current", 0));
-					fillbar->setMax(args.value().get_or("max", 0));
-				}
-				else {
-					element = self.createFillBar(idNull);
-					auto fillbar = TES3::UI::WidgetFillbar::fromElement(element);
-					fillbar->setCurrent(0);
-					fillbar->setMax(0);
-				}
-				return element;
-			});
-			usertypeDefinition.set("createHorizontalScrollPane", [](Element& self, sol::optional<sol::table> args) {
-				Element * scrollpane = nullptr;
-				if (args) {
-					scrollpane = self.createHorizontalScrollPane(args.value().get_or("id", idNull));
-				}
-				else {
-					scrollpane = self.createHorizontalScrollPane(idNull);
-				}
-
-				// Add mouse wheel handlers (see event dispatch patch in TES3UIManager.cpp)
-				scrollpane->setProperty(TES3::UI::Property::event_mouse_scroll_down, TES3::UI::onScrollPaneMousewheel);
-				scrollpane->setProperty(TES3::UI::Property::event_mouse_scroll_up, TES3::UI::onScrollPaneMousewheel);
-				return scrollpane;
-			});
-			usertypeDefinition.set("createHypertext", [](Element& self, sol::optional<sol::table> args) {
-				if (args) {
-					return self.createHypertext(args.value().get_or("id", idNull));
-				}
-				else {
-					return self.createHypertext(idNull);
-				}
-			});
-			usertypeDefinition.set("createImage", [](Element& self, sol::table args) {
-				auto path = args.get<sol::optional<const char*>>("path");
-				if (path) {
-					std::string pathStr = path.value();
-					if (pathStr.find("/") != std::string::npos) {
-						std::replace(pathStr.begin(), pathStr.end(), '/', '\\');
-					}
-
-					return self.createImage(args.get_or("id", idNull), pathStr.c_str());
-				}
-				else {
-					log::getLog() << "createImage: path argument is required." << std::endl;
-				}
-				return static_cast<Element*>(nullptr);
-			});
-			usertypeDefinition.set("createLabel", [](Element& self, sol::table args) {
-				auto text = args.get<sol::optional<const char*>>("text");
-				return self.createLabel(args.get_or("id", idNull), text.value_or("(nil)"));
-			});
-			usertypeDefinition.set("createNif", [](Element& self, sol::table args) {
-				auto path = args.get<sol::optional<const char*>>("path");
-				if (path) {
-					std::string pathStr = path.value();
-					if (pathStr.find("/") != std::string::npos) {
-						std::replace(pathStr.begin(), pathStr.end(), '/', '\\');
-					}
-
-					return self.createNif(args.get_or("id", idNull), pathStr.c_str());
-				}
-				else {
-					log::getLog() << "createNif: path argument is required." << std::endl;
-				}
-				return static_cast<Element*>(nullptr);
-			});
-			usertypeDefinition.set("createParagraphInput", [](Element& self, sol::optional<sol::table> args) {
-				if (args) {
-					return self.createParagraphInput(args.value().get_or("id", idNull));
-				}
-				else {
-					return self.createParagraphInput(idNull);
-				}
-			});
-			usertypeDefinition.set("createRect", [](Element& self, sol::table args) {
-				Element* rect = self.createRect(args.get_or("id", idNull));
-				auto argColour = args.get<sol::optional<sol::table>>("color");
-				if (argColour) {
-					auto c = argColour.value();
-					self.colourRed = c[1];
-					self.colourGreen = c[2];
-					self.colourBlue = c[3];
-					self.flagUsesRGBA = 1;
-				}
-				return rect;
-			});
-			usertypeDefinition.set("createSlider", [](Element& self, sol::table args) {
-				auto element = self.createSlider(args.get_or("id", idNull));
-				auto slider = TES3::UI::WidgetScrollBar::fromElement(element);
-				slider->setCurrent(args.get_or("current", 0));
-				slider->setMax(args.get_or("max", 0));
-				slider->setStepX(args.get_or("step", 1));
-				slider->setJumpX(args.get_or("jump", 5));
-				return element;
-			});
-			usertypeDefinition.set("createSliderVertical", [](Element& self, sol::table args) {
-				auto element = self.createSliderVertical(args.get_or("id", idNull));
-				auto slider = TES3::UI::WidgetScrollBar::fromElement(element);
-				slider->setCurrent(args.get_or("current", 0));
-				slider->setMax(args.get_or("max", 0));
-				slider->setStepX(args.get_or("step", 1));
-				slider->setJumpX(args.get_or("jump", 5));
-				return element;
-			});
-			usertypeDefinition.set("createTextInput", [](Element& self, sol::optional<sol::table> args) {
-				if (args) {
-					return self.createTextInput(args.value().get_or("id", idNull));
-				}
-				else {
-					return self.createTextInput(idNull);
-				}
-			});
-			usertypeDefinition.set("createTextSelect", [](Element& self, sol::table args) {
-				auto element = self.createTextSelect(args.get_or("id", idNull));
-				auto text = args.get<sol::optional<const char*>>("text");
-				if (text) {
-					element->setText(text.value());
-				}
-				auto textSelect = TES3::UI::WidgetTextSelect::fromElement(element);
-				auto state = args.get<sol::optional<int>>("state");
-				if (state) {
-					textSelect->setState(state.value());
-				}
-				return element;
-			});
-			usertypeDefinition.set("createThinBorder", [](Element& self, sol::optional<sol::table> args) {
-				if (args) {
-					return self.createNif(args.value().get_or("id", idNull), "menu_thin_border.nif");
-				}
-				else {
-					return self.createNif(idNull, "menu_thin_border.nif");
-				}
-			});
-			usertypeDefinition.set("createVerticalScrollPane", [](Element& self, sol::table args) {
-				auto scrollpane = self.createVerticalScrollPane(args.get_or("id", idNull));
-
-				if (args.get_or("hideFrame", false)) {
-					scrollpane->setIcon("");
-				}
-
-				// Add mouse wheel handlers (see event dispatch patch in TES3UIManager.cpp)
-				scrollpane->setProperty(TES3::UI::Property::event_mouse_scroll_down, TES3::UI::onScrollPaneMousewheel);
-				scrollpane->setProperty(TES3::UI::Property::event_mouse_scroll_up, TES3::UI::onScrollPaneMousewheel);
-				return scrollpane;
+			usertypeDefinition.set("createBlock", createBlock);
+			usertypeDefinition.set("createButton", createButton);
+			usertypeDefinition.set("createDivider", createDivider);
+			usertypeDefinition.set("createFillBar", createFillBar);
+			usertypeDefinition.set("createHorizontalScrollPane", createHorizontalScrollPane);
+			usertypeDefinition.set("createHypertext", createHypertext);
+			usertypeDefinition.set("createImage", createImage);
+			usertypeDefinition.set("createLabel", createLabel);
+			usertypeDefinition.set("createNif", createNif);
+			usertypeDefinition.set("createParagraphInput", createParagraphInput);
+			usertypeDefinition.set("createRect", createRect);
+			usertypeDefinition.set("createSlider", createSlider);
+			usertypeDefinition.set("createSliderVertical", createSliderVertical);
+			usertypeDefinition.set("createTextInput", createTextInput);
+			usertypeDefinition.set("createTextSelect", createTextSelect);
+			usertypeDefinition.set("createThinBorder", createThinBorder);
+			usertypeDefinition.set("createVerticalScrollPane", createVerticalScrollPane);
+			usertypeDefinition.set("createVirtualList", createVirtualList);
+			usertypeDefinition.set("createFromTemplate", [](sol::this_state state, Element& self, sol::table tmpl) {
+				lua_State* L = state;
+				ElementTemplateBuilder builder(L);
+				tmpl.push();
+				Element* element = builder.build(self, lua_gettop(L));
+				lua_pop(L, 1);
+				return std::make_tuple(element, builder.getRefs());
 			});
 
 			usertypeDefinition.set("destroy", [](Element& self) {
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -27,89 +29,124 @@ namespace mwse {
 		using TES3::UI::EventCallback;
 
 		struct EventLuaCallback {
-			Property id;
 			sol::protected_function callback;
 			EventCallback original;
 		};
-		static std::unordered_map<Element*, std::vector<EventLuaCallback>> eventMap;
-		static std::unordered_map<Element*, void(__cdecl*)(Element*)> destroyMap;
 
-		TES3::UI::Boolean __cdecl eventDispatcher(Element* owningWidget, Property eventID, int data0, int data1, Element* source) {
-			LuaManager& luaManager = LuaManager::getInstance();
-			sol::state& state = luaManager.getState();
+		// Lua callbacks are keyed by both element and event, so that dispatching an event is a single lookup.
+		struct ElementEventKey {
+			Element* element;
+			Property id;
+
+			bool operator==(const ElementEventKey& other) const {
+				return element == other.element && id == other.id;
+			}
+		};
+
+		struct ElementEventKeyHash {
+			size_t operator()(const ElementEventKey& key) const {
+				return std::hash<Element*>()(key.element) ^ (static_cast<size_t>(key.id) * 2654435761u);
+			}
+		};
+
+		// Per-element bookkeeping, so that all of an element's events can be removed when it's destroyed.
+		struct ElementEvents {
+			void(__cdecl* originalDestroy)(Element*);
+			std::vector<Property> ids;
+		};
 
+		static std::unordered_map<ElementEventKey, EventLuaCallback, ElementEventKeyHash> eventMap;
+		static std::unordered_map<Element*, ElementEvents> elementEventsMap;
+		static std::unordered_map<std::string, Property> propertyCache;
+
+		Property getCachedProperty(const std::string& name) {
+			auto it = propertyCache.find(name);
+			if (it != propertyCache.end()) {
+				return it->second;
+			}
+
+			// Registered IDs are never released, so the result stays valid for the rest of the session.
+			Property prop = TES3::UI::registerProperty(name.c_str());
+			propertyCache.emplace(name, prop);
+			return prop;
+		}
+
+		Property getPropertyFromLua(sol::object key) {
+			switch (key.get_type()) {
+			case sol::type::number:
+				return key.as<Property>();
+			case sol::type::string:
+				return getCachedProperty(key.as<std::string>());
+			}
+
+			throw std::invalid_argument("Invalid property. Expected a property name or a value from tes3ui.property.");
+		}
+
+		TES3::UI::Boolean __cdecl eventDispatcher(Element* owningWidget, Property eventID, int data0, int data1, Element* source) {
 			// Handle inheritance
 			Element* target = source;
 			while (target && target->getProperty(PropertyType::Property, eventID).propertyValue == Property::inherit) {
 				target = target->parent;
 			}
 
-			auto iterElements = eventMap.find(target);
-			if (iterElements != eventMap.end()) {
-				for (const auto& eventLua : iterElements->second) {
-					if (eventLua.id == eventID) {
-						sol::table eventData = luaManager.createTable();
-						eventData["source"] = source;
-						eventData["widget"] = owningWidget;
-						eventData["id"] = eventID;
-						eventData["data0"] = data0;
-						eventData["data1"] = data1;
-
-						// Note: sol::protected_function needs to be a local, as Lua functions can destroy it when modifying events.
-						sol::protected_function callback = eventLua.callback;
-						sol::protected_function_result result = callback(eventData);
-						if (result.valid()) {
-							sol::optional<TES3::UI::Boolean> value = result;
-							return value.value_or(1);
-						}
-						else {
-							sol::error error = result;
-							const char *errorSource = source->name.cString ? source->name.cString : "(unnamed)";
-							log::getLog() << "Lua error encountered during UI event from element " << errorSource << ":" << std::endl << error.what() << std::endl;
-							return 1;
-						}
-					}
-				}
+			auto iterEvent = eventMap.find({ target, eventID });
+			if (iterEvent == eventMap.end()) {
+				return 1;
 			}
 
-			return 1;
+			// Size the table for its fields up front, so filling it in doesn't need to grow it.
+			sol::table eventData = LuaManager::getInstance().createTable(0, 5);
+			eventData.raw_set("source", source, "widget", owningWidget, "id", eventID, "data0", data0, "data1", data1);
+
+			// Note: sol::protected_function needs to be a local, as Lua functions can destroy it when modifying events.
+			sol::protected_function callback = iterEvent->second.callback;
+			sol::protected_function_result result = callback(eventData);
+			if (result.valid()) {
+				sol::optional<TES3::UI::Boolean> value = result;
+				return value.value_or(1);
+			}
+			else {
+				sol::error error = result;
+				const char *errorSource = source->name.cString ? source->name.cString : "(unnamed)";
+				log::getLog() << "Lua error encountered during UI event from element " << errorSource << ":" << std::endl << error.what() << std::endl;
+				return 1;
+			}
 		}
 
 		void __cdecl eventDestroyDispatcher(Element* source) {
-			sol::state& state = LuaManager::getInstance().getState();
-
 			// Dispatch Lua callback
-			auto iterElements = eventMap.find(source);
-			if (iterElements != eventMap.end()) {
-				for (const auto& eventLua : iterElements->second) {
-					if (eventLua.id == Property::event_destroy) {
-						sol::table eventData = LuaManager::getInstance().createTable();
-						eventData["source"] = source;
-						eventData["id"] = Property::event_destroy;
-
-						// Note: sol::protected_function needs to be a local, as Lua functions can destroy it when modifying events.
-						sol::protected_function callback = eventLua.callback;
-						sol::protected_function_result result = callback();
-						if (!result.valid()) {
-							sol::error error = result;
-							const char *errorSource = source->name.cString ? source->name.cString : "(unnamed)";
-							log::getLog() << "Lua error encountered during UI event from element " << errorSource << ":" << std::endl << error.what() << std::endl;
-						}
-
-						break;
-					}
+			auto iterEvent = eventMap.find({ source, Property::event_destroy });
+			if (iterEvent != eventMap.end()) {
+				// Note: sol::protected_function needs to be a local, as Lua functions can destroy it when modifying events.
+				sol::protected_function callback = iterEvent->second.callback;
+				sol::protected_function_result result = callback();
+				if (!result.valid()) {
+					sol::error error = result;
+					const char *errorSource = source->name.cString ? source->name.cString : "(unnamed)";
+					log::getLog() << "Lua error encountered during UI event from element " << errorSource << ":" << std::endl << error.what() << std::endl;
 				}
 			}
 
+			// The callback may have changed the element's events, so look them up afterwards.
+			auto iterElement = elementEventsMap.find(source);
+			if (iterElement == elementEventsMap.end()) {
+				return;
+			}
+
 			// Call original destroy callback
-			auto callback = destroyMap[source];
-			if (callback) {
-				callback(source);
+			auto originalDestroy = iterElement->second.originalDestroy;
+			if (originalDestroy) {
+				originalDestroy(source);
 			}
 
 			// Remove event mappings
-			eventMap.erase(source);
-			destroyMap.erase(source);
+			iterElement = elementEventsMap.find(source);
+			if (iterElement != elementEventsMap.end()) {
+				for (Property id : iterElement->second.ids) {
+					eventMap.erase(ElementEventKey{ source, id });
+				}
+				elementEventsMap.erase(iterElement);
+			}
 		}
 
 		void registerUIEvent(Element& target, Property eventID, sol::protected_function callback) {
@@ -119,12 +156,13 @@ namespace mwse {
 				prevCallback = nullptr;
 			}
 
-			if (eventMap.find(&target) == eventMap.end()) {
+			auto iterElement = elementEventsMap.find(&target);
+			if (iterElement == elementEventsMap.end()) {
 				// Set a destroy hook the first time an event is added to an Element to allow cleanup
 				// This callback uses PropertyType::Pointer instead of PropertyType::EventCallback
 				auto prevDestroy = target.getProperty(PropertyType::Pointer, Property::event_destroy).ptrValue;
 				target.setProperty(Property::event_destroy, static_cast<void*>(&eventDestroyDispatcher));
-				destroyMap[&target] = static_cast<void (__cdecl*)(Element*)>(prevDestroy);
+				iterElement = elementEventsMap.emplace(&target, ElementEvents{ static_cast<void (__cdecl*)(Element*)>(prevDestroy) }).first;
 			}
 
 			// Forward the event to our dispatcher
@@ -133,39 +171,40 @@ namespace mwse {
 			}
 
 			// Check for existing event to replace
-			auto& elementEvents = eventMap[&target];
-			for (auto& eventPair : elementEvents) {
-				if (eventPair.id == eventID) {
-					eventPair.callback = callback;
-					return;
-				}
+			auto iterEvent = eventMap.find({ &target, eventID });
+			if (iterEvent != eventMap.end()) {
+				iterEvent->second.callback = callback;
+				return;
 			}
 
-			// Add new event to list
-			elementEvents.push_back(EventLuaCallback{ eventID, callback, prevCallback });
+			// Add new event
+			eventMap.emplace(ElementEventKey{ &target, eventID }, EventLuaCallback{ callback, prevCallback });
+			iterElement->second.ids.push_back(eventID);
 		}
 
 		void unregisterUIEvent(Element& target, Property eventID) {
-			auto& elementEvents = eventMap[&target];
-
 			// Check for existing event
-			for (auto it = elementEvents.begin(); it != elementEvents.end(); ++it) {
-				if (it->id == eventID) {
-					// Restore callback
-					if (eventID != Property::event_destroy) {
-						target.setProperty(eventID, it->original);
-					}
+			auto iterEvent = eventMap.find({ &target, eventID });
+			if (iterEvent == eventMap.end()) {
+				return;
+			}
 
-					// Remove event
-					elementEvents.erase(it);
-					return;
-				}
+			// Restore callback
+			if (eventID != Property::event_destroy) {
+				target.setProperty(eventID, iterEvent->second.original);
+			}
+
+			// Remove event
+			eventMap.erase(iterEvent);
+
+			auto iterElement = elementEventsMap.find(&target);
+			if (iterElement != elementEventsMap.end()) {
+				auto& ids = iterElement->second.ids;
+				ids.erase(std::remove(ids.begin(), ids.end(), eventID), ids.end());
 			}
 		}
 
 		TES3::UI::Boolean eventForwarder(sol::table eventData) {
-			sol::state& state = LuaManager::getInstance().getState();
-
 			Element* source = eventData["source"];
 			Element* owningWidget = eventData["widget"];
 			Property eventID = eventData["id"];
@@ -178,14 +217,10 @@ namespace mwse {
 				target = target->parent;
 			}
 
-			auto iterElements = eventMap.find(target);
-			if (iterElements != eventMap.end()) {
-				for (const auto& eventLua : iterElements->second) {
-					if (eventLua.id == eventID && eventLua.original) {
-						// Call original callback
-						return eventLua.original(owningWidget, eventID, data0, data1, source);
-					}
-				}
+			auto iterEvent = eventMap.find({ target, eventID });
+			if (iterEvent != eventMap.end() && iterEvent->second.original) {
+				// Call original callback
+				return iterEvent->second.original(owningWidget, eventID, data0, data1, source);
 			}
 			return 1;
 		}
@@ -197,6 +232,77 @@ namespace mwse {
 			}
 		}
 
+		Element* findLayoutBoundary(Element* element) {
+			// Never go past the menu, as laying out a UI root lays out every menu under it.
+			Element* menu = element->getTopLevelParent();
+			while (element != menu && element->parent) {
+				if (!element->flagAutoWidth && !element->flagAutoHeight && element->widthProportional < 0.0f && element->heightProportional < 0.0f) {
+					break;
+				}
+				element = element->parent;
+			}
+			return element;
+		}
+
+		static int layoutBatchDepth = 0;
+		static std::unordered_set<Element*> pendingLayouts;
+		static std::unordered_set<Element*> pendingLayoutMenus;
+
+		void requestLayout(Element& element) {
+			if (layoutBatchDepth == 0) {
+				element.performLayout(1);
+				return;
+			}
+
+			pendingLayouts.insert(&element);
+			pendingLayoutMenus.insert(element.getTopLevelParent());
+		}
+
+		static void collectPendingLayouts(Element* element, Element* menu, const std::unordered_set<Element*>& pending, std::vector<Element*>& roots) {
+			if (pending.find(element) != pending.end()) {
+				// The element's own size or position may have changed, so its parent needs laying out too.
+				// A menu has nothing above it to lay out.
+				roots.push_back(findLayoutBoundary(element == menu ? element : element->parent));
+			}
+
+			for (auto itt = element->vectorChildren.begin; itt != element->vectorChildren.end; itt++) {
+				collectPendingLayouts(*itt, menu, pending, roots);
+			}
+		}
+
+		static void flushPendingLayouts() {
+			std::unordered_set<Element*> pending, menus;
+			pending.swap(pendingLayouts);
+			menus.swap(pendingLayoutMenus);
+
+			// Queued elements may have been destroyed since, so only look for them in menus that still exist.
+			std::vector<Element*> roots;
+			auto menuController = TES3::WorldController::get()->menuController;
+			for (Element* root : { menuController->mainRoot, menuController->helpRoot }) {
+				for (auto itt = root->vectorChildren.begin; itt != root->vectorChildren.end; itt++) {
+					if (menus.find(*itt) != menus.end()) {
+						collectPendingLayouts(*itt, *itt, pending, roots);
+					}
+				}
+			}
+
+			// Skip any root that will already be laid out as part of another.
+			std::unordered_set<Element*> rootSet(roots.begin(), roots.end());
+			for (Element* root : rootSet) {
+				bool covered = false;
+				for (Element* ancestor = root->parent; ancestor; ancestor = ancestor->parent) {
+					if (rootSet.find(ancestor) != rootSet.end()) {
+						covered = true;
+						break;
+					}
+				}
+
+				if (!covered) {
+					root->performLayout(1);
+				}
+			}
+		}
+
 		void bindTES3UIManager() {
 			sol::state& state = LuaManager::getInstance().getState();
 			auto tes3ui = state.create_named_table("tes3ui");
@@ -204,6 +310,22 @@ namespace mwse {
 			tes3ui["registerID"] = TES3::UI::registerID;
 			tes3ui["lookupID"] = TES3::UI::lookupID;
 			tes3ui["registerProperty"] = TES3::UI::registerProperty;
+			tes3ui["property"] = getCachedProperty;
+			tes3ui["batchLayout"] = [](sol::protected_function callback) {
+				layoutBatchDepth++;
+				sol::protected_function_result result = callback();
+				layoutBatchDepth--;
+
+				// Lay out everything that was queued, even if the callback failed part way through.
+				if (layoutBatchDepth == 0) {
+					flushPendingLayouts();
+				}
+
+				if (!result.valid()) {
+					sol::error error = result;
+					throw error;
+				}
+			};
 			tes3ui.set_function("createMenu", [](sol::table args) {
 				auto id = args.get<sol::optional<UI_ID>>("id");
 				if (!id) {
@@ -10,6 +10,21 @@ namespace mwse {
 		TES3::UI::Boolean eventForwarder(sol::table eventData);
 		void triggerEvent(TES3::UI::Element& target, TES3::UI::Property eventID, int data0, int data1);
 
+		// Registers a property name, remembering the result so the engine's registry is only searched once per name.
+		TES3::UI::Property getCachedProperty(const std::string& name);
+
+		// Accepts either a property name or a handle returned by tes3ui.property.
+		TES3::UI::Property getPropertyFromLua(sol::object key);
+
+		// Returns the closest element, starting from the given one, whose size doesn't depend on its contents
+		// or its parent. Changes inside that element can be laid out without touching the rest of the menu.
+		// The search stops at the element's menu, so a UI root is never returned.
+		TES3::UI::Element* findLayoutBoundary(TES3::UI::Element* element);
+
+		// Lays out an element. While tes3ui.batchLayout is running, the request is queued instead, and all
+		// queued requests are laid out together once the batch finishes.
+		void requestLayout(TES3::UI::Element& element);
+
 		void bindTES3UIManager();
 	}
 }
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstdlib>
 #include <string>
 
 #include "TES3UIManager.h"
@@ -394,5 +396,167 @@ namespace TES3 {
 		void WidgetTextSelect::setColourActive(const float(&c)[3]) { setColourProperty(*this, propSelectActive, c); }
 		void WidgetTextSelect::setColourActiveOver(const float(&c)[3]) { setColourProperty(*this, propSelectActiveOver, c); }
 		void WidgetTextSelect::setColourActivePressed(const float(&c)[3]) { setColourProperty(*this, propSelectActivePressed, c); }
+
+		//
+		// WidgetVirtualList
+		//
+		static Property propVirtualList;
+		static Property propVirtualListRowCount, propVirtualListRowHeight;
+		static Property propVirtualListFirstRow, propVirtualListViewHeight, propVirtualListRowIndex;
+		static UI_ID uiidVirtualListPane, uiidVirtualListRows, uiidVirtualListRow;
+		static UI_ID uiidVirtualListTopSpacer, uiidVirtualListBottomSpacer;
+
+		bool WidgetVirtualList::initProperties() {
+			propVirtualList = registerProperty("PartVirtualList");
+			propVirtualListRowCount = registerProperty("PartVirtualList_row_count");
+			propVirtualListRowHeight = registerProperty("PartVirtualList_row_height");
+			propVirtualListFirstRow = registerProperty("PartVirtualList_first_row");
+			propVirtualListViewHeight = registerProperty("PartVirtualList_view_height");
+			propVirtualListRowIndex = registerProperty("PartVirtualList_row_index");
+			uiidVirtualListPane = registerID("PartVirtualList_pane");
+			uiidVirtualListRows = registerID("PartVirtualList_rows");
+			uiidVirtualListRow = registerID("PartVirtualList_row");
+			uiidVirtualListTopSpacer = registerID("PartVirtualList_top_spacer");
+			uiidVirtualListBottomSpacer = registerID("PartVirtualList_bottom_spacer");
+			return true;
+		}
+
+		WidgetVirtualList* WidgetVirtualList::fromElement(Element* element) {
+			static bool initialized = initProperties();
+			return static_cast<WidgetVirtualList*>(element);
+		}
+
+		static Element* createSpacer(Element* parent, UI_ID id) {
+			Element* spacer = parent->createBlock(id);
+			spacer->widthProportional = 1.0f;
+			spacer->setAutoHeight(false);
+			spacer->setProperty(Property::height, 0);
+			return spacer;
+		}
+
+		WidgetVirtualList* WidgetVirtualList::create(Element* parent, UI_ID id) {
+			Element* list = parent->createBlock(id);
+			auto widget = fromElement(list);
+			list->setProperty(Property::is_part, propVirtualList);
+			list->setProperty(Property::flow_direction, Property::top_to_bottom);
+			list->setProperty(propVirtualListFirstRow, -1);
+			list->setProperty(propVirtualListViewHeight, -1);
+
+			Element* pane = list->createVerticalScrollPane(uiidVirtualListPane);
+			pane->widthProportional = 1.0f;
+			pane->heightProportional = 1.0f;
+			pane->setProperty(Property::event_mouse_scroll_down, onScrollPaneMousewheel);
+			pane->setProperty(Property::event_mouse_scroll_up, onScrollPaneMousewheel);
+
+			Element* content = WidgetScrollPane::fromElement(pane)->getContentPane();
+			content->setProperty(Property::flow_direction, Property::top_to_bottom);
+
+			createSpacer(content, uiidVirtualListTopSpacer);
+			Element* rows = content->createBlock(uiidVirtualListRows);
+			rows->widthProportional = 1.0f;
+			rows->setAutoHeight(true);
+			rows->setProperty(Property::flow_direction, Property::top_to_bottom);
+			createSpacer(content, uiidVirtualListBottomSpacer);
+
+			return widget;
+		}
+
+		int WidgetVirtualList::getRowCount() const {
+			return getProperty(PropertyType::Integer, propVirtualListRowCount).integerValue;
+		}
+		void WidgetVirtualList::setRowCount(int count) {
+			setProperty(propVirtualListRowCount, std::max(count, 0));
+			setProperty(propVirtualListViewHeight, -1);
+		}
+
+		int WidgetVirtualList::getRowHeight() const {
+			return getProperty(PropertyType::Integer, propVirtualListRowHeight).integerValue;
+		}
+		void WidgetVirtualList::setRowHeight(int height) {
+			setProperty(propVirtualListRowHeight, std::max(height, 1));
+			setProperty(propVirtualListViewHeight, -1);
+		}
+
+		WidgetScrollPane* WidgetVirtualList::getScrollPane() const {
+			return WidgetScrollPane::fromElement(findChild(uiidVirtualListPane));
+		}
+
+		Element* WidgetVirtualList::getRowContainer() const {
+			return findChild(uiidVirtualListRows);
+		}
+
+		int WidgetVirtualList::getRowIndex(const Element* row) const {
+			// Stored off by one, so that rows without the property read as unused.
+			return row->getProperty(PropertyType::Integer, propVirtualListRowIndex).integerValue - 1;
+		}
+
+		void WidgetVirtualList::scrollToRow(int index) {
+			auto pane = getScrollPane();
+			int rowHeight = std::max(getRowHeight(), 1);
+			int maxPosition = std::max(getRowCount() * rowHeight - pane->height, 0);
+			pane->setVerticalPos(std::min(std::max(index * rowHeight, 0), maxPosition));
+		}
+
+		bool WidgetVirtualList::updateVisibleRows(std::vector<Element*>& changedRows, bool force) {
+			auto pane = getScrollPane();
+			int rowCount = std::max(getRowCount(), 0);
+			int rowHeight = std::max(getRowHeight(), 1);
+			int viewHeight = std::max(pane->height, 0);
+
+			// One extra row for the partially visible row at each edge.
+			int visibleCount = viewHeight / rowHeight + 2;
+			int first = std::min(std::max(pane->getVerticalPos() / rowHeight, 0), std::max(rowCount - visibleCount, 0));
+			visibleCount = std::min(visibleCount, rowCount - first);
+
+			int previousFirst = getProperty(PropertyType::Integer, propVirtualListFirstRow).integerValue;
+			int previousViewHeight = getProperty(PropertyType::Integer, propVirtualListViewHeight).integerValue;
+			if (!force && first == previousFirst && viewHeight == previousViewHeight) {
+				return false;
+			}
+
+			// Pooled rows are kept in display order. Rotate them so that rows still in view line up with their new position.
+			Element* rows = getRowContainer();
+			int poolSize = rows->vectorChildren.end - rows->vectorChildren.begin;
+			int delta = first - previousFirst;
+			if (previousFirst >= 0 && delta != 0 && std::abs(delta) < poolSize) {
+				rows->reorderChildren(0, delta > 0 ? delta : poolSize + delta, -1);
+			}
+
+			// Grow the pool to cover the view. It is never shrunk, so resizing back and forth doesn't recreate rows.
+			for (int i = poolSize; i < visibleCount; i++) {
+				Element* row = rows->createBlock(uiidVirtualListRow);
+				row->widthProportional = 1.0f;
+				row->setAutoHeight(false);
+			}
+			poolSize = rows->vectorChildren.end - rows->vectorChildren.begin;
+
+			for (int i = 0; i < poolSize; i++) {
+				Element* row = rows->vectorChildren.begin[i];
+				if (i < visibleCount) {
+					if (force || getRowIndex(row) != first + i) {
+						row->setProperty(propVirtualListRowIndex, first + i + 1);
+						row->setProperty(Property::height, rowHeight);
+						changedRows.push_back(row);
+					}
+					if (!row->visible) {
+						row->setVisible(true);
+					}
+				}
+				else {
+					row->setProperty(propVirtualListRowIndex, 0);
+					if (row->visible) {
+						row->setVisible(false);
+					}
+				}
+			}
+
+			findChild(uiidVirtualListTopSpacer)->setProperty(Property::height, first * rowHeight);
+			findChild(uiidVirtualListBottomSpacer)->setProperty(Property::height, (rowCount - first - visibleCount) * rowHeight);
+
+			setProperty(propVirtualListFirstRow, first);
+			setProperty(propVirtualListViewHeight, viewHeight);
+
+			return true;
+		}
 	}
 }
\ No newline at end of file
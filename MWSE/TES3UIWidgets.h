@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "TES3UIElement.h"
 
 namespace TES3 {
@@ -120,5 +121,31 @@ namespace TES3 {
 		private:
 			static bool initProperties();
 		};
+
+		// A vertical list that only creates elements for the rows in view. Spacers above and below the
+		// visible rows keep the scroll pane's content at the full height of the list.
+		struct WidgetVirtualList : Element {
+			int getRowCount() const;
+			void setRowCount(int count);
+			int getRowHeight() const;
+			void setRowHeight(int height);
+			WidgetScrollPane* getScrollPane() const;
+			Element* getRowContainer() const;
+
+			// Returns the 0-based index of the list row a pooled row element is showing, or -1 if it's unused.
+			int getRowIndex(const Element* row) const;
+			void scrollToRow(int index);
+
+			// Assigns pooled rows to the rows currently in view, rotating the pool so that rows which stay in
+			// view keep their contents. Rows that need new contents are added to changedRows; with force set,
+			// that is every visible row. Returns false if the view hasn't changed since the last update.
+			bool updateVisibleRows(std::vector<Element*>& changedRows, bool force = false);
+
+			WidgetVirtualList() = delete;
+			static WidgetVirtualList* create(Element* parent, UI_ID id);
+			static WidgetVirtualList* fromElement(Element* e);
+		private:
+			static bool initProperties();
+		};
 	}
 }
\ No newline at end of file
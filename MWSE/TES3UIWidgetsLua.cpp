@@ -1,8 +1,13 @@
+#include <unordered_map>
+#include <vector>
+
 #include "TES3UIManager.h"
+#include "TES3UIManagerLua.h"
 #include "TES3UIWidgets.h"
 
 #include "sol.hpp"
 #include "LuaManager.h"
+#include "Log.h"
 
 namespace mwse {
 	namespace lua {
@@ -17,12 +22,13 @@ namespace mwse {
 		using TES3::UI::WidgetScrollPane;
 		using TES3::UI::WidgetTextInput;
 		using TES3::UI::WidgetTextSelect;
+		using TES3::UI::WidgetVirtualList;
 		using TES3::UI::registerID;
 		using TES3::UI::registerProperty;
 
 		static Property propButton, propFillbar, propParagraphInput;
 		static Property propScrollBar, propScrollPaneH, propScrollPaneV;
-		static Property propTextInput, propTextSelect;
+		static Property propTextInput, propTextSelect, propVirtualList;
 		static UI_ID uiidButtonText, uiidParagraphInputText;
 
 		void bindTES3UIWidgets();
@@ -38,6 +44,7 @@ namespace mwse {
 				propScrollPaneV = registerProperty("PartScrollPaneVert");
 				propTextInput = registerProperty("PartTextInput");
 				propTextSelect = registerProperty("PartTextSelect");
+				propVirtualList = registerProperty("PartVirtualList");
 				uiidButtonText = registerID("PartButton_text_ptr");
 				uiidParagraphInputText = registerID("PartParagraphInput_text_input");
 				init = true;
@@ -72,6 +79,9 @@ namespace mwse {
 			else if (part == propTextSelect) {
 				widget = sol::make_object(state, WidgetTextSelect::fromElement(&element));
 			}
+			else if (part == propVirtualList) {
+				widget = sol::make_object(state, WidgetVirtualList::fromElement(&element));
+			}
 			return widget;
 		}
 
@@ -115,6 +125,96 @@ namespace mwse {
 			element.getTopLevelParent()->timingUpdate();
 		}
 
+		// Row data sources for each virtual list.
+		static std::unordered_map<Element*, sol::protected_function> virtualListPopulators;
+
+		static bool populateVirtualList(WidgetVirtualList& list, bool force) {
+			std::vector<Element*> changedRows;
+			if (!list.updateVisibleRows(changedRows, force)) {
+				return false;
+			}
+
+			auto it = virtualListPopulators.find(&list);
+			if (it == virtualListPopulators.end()) {
+				return true;
+			}
+
+			// Note: sol::protected_function needs to be a local, as the callback may replace itself.
+			sol::protected_function populate = it->second;
+			for (Element* row : changedRows) {
+				sol::protected_function_result result = populate(row, list.getRowIndex(row) + 1);
+				if (!result.valid()) {
+					sol::error error = result;
+					const char *errorSource = list.name.cString ? list.name.cString : "(unnamed)";
+					log::getLog() << "Lua error encountered while populating virtual list " << errorSource << ":" << std::endl << error.what() << std::endl;
+					break;
+				}
+			}
+
+			return true;
+		}
+
+		static void refreshVirtualList(WidgetVirtualList& list, bool force) {
+			if (!populateVirtualList(list, force)) {
+				return;
+			}
+
+			// The rows don't change the list's size, so only the list needs laying out.
+			Element* boundary = findLayoutBoundary(&list);
+			if (force) {
+				// The scroll pane needs the new content height now, so this can't wait for a layout batch.
+				boundary->performLayout(1);
+				list.getScrollPane()->contentPaneChanged();
+			}
+			else {
+				requestLayout(*boundary);
+			}
+		}
+
+		Element* createVirtualList(Element& parent, sol::table args) {
+			sol::optional<sol::protected_function> populate = args["populate"];
+			if (!populate) {
+				log::getLog() << "createVirtualList: populate argument is required." << std::endl;
+				return nullptr;
+			}
+
+			auto list = WidgetVirtualList::create(&parent, args.get_or("id", static_cast<UI_ID>(Property::null)));
+			list->setRowHeight(args.get_or("rowHeight", 20));
+			list->setRowCount(args.get_or("rowCount", 0));
+			virtualListPopulators[list] = populate.value();
+
+			// Forget the data source when the list is destroyed. The hook goes on an internal element, so
+			// that it can't be replaced by a destroy event registered on the list itself.
+			sol::state& state = LuaManager::getInstance().getState();
+			registerUIEvent(*list->getRowContainer(), Property::event_destroy, sol::make_object(state, [list]() {
+				virtualListPopulators.erase(list);
+			}).as<sol::protected_function>());
+
+			// Fill in the first rows now. The rest follow once the list has been laid out and knows its height.
+			populateVirtualList(*list, true);
+
+			return list;
+		}
+
+		void updateVirtualLists() {
+			if (virtualListPopulators.empty()) {
+				return;
+			}
+
+			// Callbacks may create or destroy lists, so work from a copy.
+			std::vector<Element*> lists;
+			lists.reserve(virtualListPopulators.size());
+			for (const auto& entry : virtualListPopulators) {
+				lists.push_back(entry.first);
+			}
+
+			for (Element* list : lists) {
+				if (virtualListPopulators.find(list) != virtualListPopulators.end()) {
+					refreshVirtualList(*WidgetVirtualList::fromElement(list), false);
+				}
+			}
+		}
+
 		void bindTES3UIWidgets() {
 			sol::state& state = LuaManager::getInstance().getState();
 
@@ -298,6 +398,44 @@ namespace mwse {
 
 				state.set_usertype("tes3uiTextSelect", usertypeDefinition);
 			}
+
+			//
+			// VirtualList (PartVirtualList)
+			//
+			{
+				auto usertypeDefinition = state.create_simple_usertype<WidgetVirtualList>();
+				usertypeDefinition.set("new", sol::no_constructor);
+
+				usertypeDefinition.set("rowCount", sol::property(
+					&WidgetVirtualList::getRowCount,
+					[](WidgetVirtualList& self, int count) {
+						self.setRowCount(count);
+						refreshVirtualList(self, true);
+					}
+				));
+				usertypeDefinition.set("rowHeight", sol::property(
+					&WidgetVirtualList::getRowHeight,
+					[](WidgetVirtualList& self, int height) {
+						self.setRowHeight(height);
+						refreshVirtualList(self, true);
+					}
+				));
+				usertypeDefinition.set("populate", sol::property(
+					[](WidgetVirtualList& self, sol::protected_function populate) {
+						virtualListPopulators[&self] = populate;
+						refreshVirtualList(self, true);
+					}
+				));
+				usertypeDefinition.set("scrollPane", sol::readonly_property([](WidgetVirtualList& self) -> Element* { return self.getScrollPane(); }));
+
+				usertypeDefinition.set("refresh", [](WidgetVirtualList& self) { refreshVirtualList(self, true); });
+				usertypeDefinition.set("scrollToRow", [](WidgetVirtualList& self, int index) {
+					self.scrollToRow(index - 1);
+					refreshVirtualList(self, false);
+				});
+
+				state.set_usertype("tes3uiVirtualList", usertypeDefinition);
+			}
 		}
 
 	}
@@ -11,5 +11,10 @@ namespace mwse {
 		sol::object makeWidget(TES3::UI::Element& element);
 		std::string getWidgetText(TES3::UI::Element& element);
 		void setWidgetText(TES3::UI::Element& element, const char* text);
+
+		TES3::UI::Element* createVirtualList(TES3::UI::Element& parent, sol::table args);
+
+		// Repopulates the visible rows of any virtual lists that were scrolled or resized. Called every frame.
+		void updateVirtualLists();
 	}
 }
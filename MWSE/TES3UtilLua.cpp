@@ -13,6 +13,10 @@
 #include "Log.h"
 #include "ScriptUtil.h"
 #include "CodePatchUtil.h"
+#include "NIUtil.h"
+#include "ObjectIdIndex.h"
+#include "ObjectTypeIndex.h"
+#include "ReferenceSpatialIndex.h"
 
 #include "NICamera.h"
 #include "NINode.h"
@@ -66,27 +70,390 @@
 
 namespace mwse {
 	namespace lua {
-		auto iterateObjectsFiltered(unsigned int desiredType) {
-			TES3::Object* object = TES3::DataHandler::get()->nonDynamicData->list->head;
-			return [object, desiredType]() mutable -> sol::object {
-				while (object && desiredType != 0 && object->objectType != desiredType) {
+		// Iterates over objects of the given types, one type after another. With no types, every object is visited.
+		auto iterateObjectsOfTypes(std::vector<unsigned int> desiredTypes) {
+			TES3::Object* object = desiredTypes.empty() ? TES3::DataHandler::get()->nonDynamicData->list->head : nullptr;
+			size_t typeIndex = 0;
+			size_t position = 0;
+			return [object, desiredTypes, typeIndex, position]() mutable -> sol::object {
+				// Walk the whole object list.
+				if (desiredTypes.empty()) {
+					if (object == NULL) {
+						return sol::nil;
+					}
+
+					sol::object ret = makeLuaObject(object);
 					object = object->nextInCollection;
+					return ret;
 				}
 
-				if (object == NULL) {
-					return sol::nil;
+				// Only visit the objects of the types we want.
+				auto& index = tes3::ObjectTypeIndex::getInstance();
+				while (typeIndex < desiredTypes.size()) {
+					const auto& objects = index.getObjects(desiredTypes[typeIndex]);
+					while (position < objects.size()) {
+						TES3::Object* found = objects[position++];
+						if (found) {
+							return makeLuaObject(found);
+						}
+					}
+
+					typeIndex++;
+					position = 0;
 				}
 
-				sol::object ret = makeLuaObject(object);
-				object = object->nextInCollection;
-				return ret;
+				return sol::nil;
 			};
 		}
 
+		auto iterateObjectsFiltered(unsigned int desiredType) {
+			std::vector<unsigned int> desiredTypes;
+			if (desiredType != 0) {
+				desiredTypes.push_back(desiredType);
+			}
+			return iterateObjectsOfTypes(desiredTypes);
+		}
+
+		auto iterateObjectsFilteredByTable(sol::table desiredTypesTable) {
+			std::vector<unsigned int> desiredTypes;
+			for (size_t i = 1, size = desiredTypesTable.size(); i <= size; i++) {
+				desiredTypes.push_back(desiredTypesTable.get<unsigned int>(i));
+			}
+			return iterateObjectsOfTypes(desiredTypes);
+		}
+
 		auto iterateObjects() {
-			return iterateObjectsFiltered(0);
+			return iterateObjectsOfTypes({});
 		}
 
+		// Reads an objectType filter, which can be either a single type or an array of types.
+		std::vector<unsigned int> getOptionalParamObjectTypes(sol::optional<sol::table> params, const char* key) {
+			std::vector<unsigned int> types;
+			if (!params) {
+				return types;
+			}
+
+			sol::object value = params.value()[key];
+			if (value.is<double>()) {
+				types.push_back(value.as<unsigned int>());
+			}
+			else if (value.is<sol::table>()) {
+				sol::table valueTable = value;
+				for (size_t i = 1, size = valueTable.size(); i <= size; i++) {
+					types.push_back(valueTable.get<unsigned int>(i));
+				}
+			}
+
+			return types;
+		}
+
+		sol::table makeReferenceArray(const std::vector<TES3::Reference*>& references) {
+			sol::table result = LuaManager::getInstance().getState().create_table(references.size(), 0);
+			for (size_t i = 0; i < references.size(); i++) {
+				result[i + 1] = makeLuaObject(references[i]);
+			}
+			return result;
+		}
+
+		// Pick shared by all ray tests. It is configured fresh from the given parameters for each call.
+		static NI::Pick* rayTestCache = nullptr;
+		NI::Pick* getRayTestPick(sol::optional<sol::table> params, bool findAll, bool defaultReturnNormal = true) {
+			// Create our pick if it doesn't exist.
+			if (rayTestCache == nullptr) {
+				rayTestCache = NI::Pick::malloc();
+			}
+
+			// Or clean up results otherwise.
+			else {
+				rayTestCache->clearResults();
+			}
+
+			// TODO: Allow specifying the root?
+			rayTestCache->root = TES3::Game::get()->worldRoot;
+
+			// Are we finding all or the first?
+			if (findAll) {
+				rayTestCache->pickType = NI::PickType::FIND_ALL;
+			}
+			else {
+				rayTestCache->pickType = NI::PickType::FIND_FIRST;
+			}
+
+			// Sort results by distance?
+			if (getOptionalParam<bool>(params, "sort", true)) {
+				rayTestCache->sortType = NI::PickSortType::SORT;
+			}
+			else {
+				rayTestCache->sortType = NI::PickSortType::NO_SORT;
+			}
+
+			// Use triangle or model bounds for intersection?
+			if (getOptionalParam<bool>(params, "useModelBounds", false)) {
+				rayTestCache->intersectType = NI::PickIntersectType::BOUND_INTERSECT;
+			}
+			else {
+				rayTestCache->intersectType = NI::PickIntersectType::TRIANGLE_INTERSECT;
+			}
+
+			// Use model coordinates or world coordinates?
+			if (getOptionalParam<bool>(params, "useModelCoordinates", false)) {
+				rayTestCache->coordinateType = NI::PickCoordinateType::MODEL_COORDINATES;
+			}
+			else {
+				rayTestCache->coordinateType = NI::PickCoordinateType::WORLD_COORDINATES;
+			}
+
+			// Use the back side of a triangle? Note: Parameter name flipped!
+			rayTestCache->frontOnly = !getOptionalParam<bool>(params, "useBackTriangles", false);
+
+			// Observe app cull flag?
+			rayTestCache->observeAppCullFlag = getOptionalParam<bool>(params, "observeAppCullFlag", true);
+
+			// Determine what returned values we care about.
+			rayTestCache->returnColor = getOptionalParam<bool>(params, "returnColor", false);
+			rayTestCache->returnNormal = getOptionalParam<bool>(params, "returnNormal", defaultReturnNormal);
+			rayTestCache->returnSmoothNormal = getOptionalParam<bool>(params, "returnSmoothNormal", false);
+			rayTestCache->returnTexture = getOptionalParam<bool>(params, "returnTexture", false);
+
+			return rayTestCache;
+		}
+
+		// Gets a table from a parent table, creating it if it doesn't exist yet.
+		sol::table getOrCreateSubtable(sol::table& parent, const char* key) {
+			sol::object value = parent.raw_get<sol::object>(key);
+			if (value.is<sol::table>()) {
+				return value;
+			}
+
+			sol::table table = LuaManager::getInstance().createTable();
+			parent.raw_set(key, table);
+			return table;
+		}
+
+		// Moves items between two references. Any number of items can be transferred before calling
+		// finish, which takes care of sounds, equipment, and GUI updates for all of them at once.
+		class ItemTransfer {
+		public:
+			ItemTransfer(sol::table params) {
+				// Get the reference we are transferring from.
+				fromReference = getOptionalParamReference(params, "from");
+				if (fromReference == nullptr) {
+					throw std::invalid_argument("Invalid 'from' parameter provided.");
+				}
+
+				// Get the reference we are transferring to.
+				toReference = getOptionalParamReference(params, "to");
+				if (toReference == nullptr) {
+					throw std::invalid_argument("Invalid 'to' parameter provided.");
+				}
+
+				// Make sure we're dealing with actors.
+				fromActor = static_cast<TES3::Actor*>(fromReference->baseObject);
+				if (!fromActor->isActor()) {
+					throw std::invalid_argument("The 'from' reference does not point to an actor.");
+				}
+				toActor = static_cast<TES3::Actor*>(toReference->baseObject);
+				if (!toActor->isActor()) {
+					throw std::invalid_argument("The 'to' reference does not point to an actor.");
+				}
+
+				// Do either of the references need to be cloned?
+				if (fromReference->clone()) {
+					fromActor = static_cast<TES3::Actor*>(fromReference->baseObject);
+				}
+				if (toReference->clone()) {
+					toActor = static_cast<TES3::Actor*>(toReference->baseObject);
+				}
+
+				// Get the mobile objects for the references, if applicable.
+				toMobile = toReference->getAttachedMobileActor();
+				fromMobile = fromReference->getAttachedMobileActor();
+
+				// Are we looking at a non-container?
+				fromIsContainer = (fromActor->objectType == TES3::ObjectType::Container);
+
+				// Manage anything we need to regarding containers.
+				if (toActor->objectType == TES3::ObjectType::Container && getOptionalParam<bool>(params, "limitCapacity", true)) {
+					// Prevent placing items into organic containers.
+					if (toActor->getActorFlag(TES3::ActorFlagContainer::Organic)) {
+						blocked = true;
+						return;
+					}
+
+					// Figure out the max capacity and currently stored weight of the container.
+					maxCapacity = static_cast<TES3::Container*>(toReference->getBaseObject())->capacity;
+					currentWeight = toActor->inventory.calculateContainedWeight();
+					if (currentWeight > maxCapacity) {
+						blocked = true;
+					}
+				}
+			}
+
+			// Transfers up to the desired count of an item. Returns the number of items actually transferred.
+			int transfer(TES3::Item * item, TES3::ItemData * itemData, int desiredCount) {
+				if (blocked) {
+					return 0;
+				}
+
+				// Is the item leveled? Let's resolve it first.
+				while (item->objectType == TES3::ObjectType::LeveledItem) {
+					item = static_cast<TES3::Item*>(reinterpret_cast<TES3::LeveledItem*>(item)->resolve());
+				}
+
+				int fulfilledCount = 0;
+				float itemWeight = item->getWeight();
+
+				// Were we given an ItemData? If so, we only need to transfer one item.
+				if (itemData) {
+					if ((maxCapacity == -1.0f || currentWeight + itemWeight <= maxCapacity) && fromActor->inventory.containsItem(item, itemData)) {
+						toActor->inventory.addItem(toMobile, item, 1, false, &itemData);
+						fromActor->inventory.removeItemWithData(fromMobile, item, itemData, 1, false);
+
+						if (!fromIsContainer) {
+							fromActor->unequipItem(item, true, fromMobile, false, itemData);
+						}
+
+						fulfilledCount = 1;
+						currentWeight += itemWeight;
+					}
+				}
+				// No ItemData? We have to go through and transfer items over one by one.
+				else {
+					TES3::ItemStack * fromStack = fromActor->inventory.findItemStack(item);
+					if (fromStack) {
+						int stackCount = std::abs(fromStack->count);
+						int itemsLeftToTransfer = std::min(desiredCount, stackCount);
+
+						// If we're limited by capacity, find out how many items we really want to transfer.
+						if (maxCapacity != -1.0f) {
+							itemsLeftToTransfer = std::min(itemsLeftToTransfer, (int)std::floorf((maxCapacity - currentWeight) / itemWeight));
+						}
+
+						if (itemsLeftToTransfer <= 0) {
+							return 0;
+						}
+
+						// Remove transfer items without data first.
+						int countWithoutVariables = stackCount - (fromStack->variables ? fromStack->variables->endIndex : 0);
+						if (countWithoutVariables > 0) {
+							int amountToTransfer = std::min(countWithoutVariables, itemsLeftToTransfer);
+							toActor->inventory.addItem(toMobile, item, amountToTransfer, false, nullptr);
+							fromActor->inventory.removeItemWithData(fromMobile, item, nullptr, amountToTransfer, false);
+							fulfilledCount += amountToTransfer;
+							itemsLeftToTransfer -= amountToTransfer;
+						}
+
+						// Then transfer over items with data.
+						if (fromStack->variables) {
+							while (itemsLeftToTransfer > 0) {
+								auto itemData = fromStack->variables->storage[0];
+								toActor->inventory.addItem(toMobile, item, 1, false, &fromStack->variables->storage[0]);
+								fromActor->inventory.removeItemWithData(fromMobile, item, itemData, 1, false);
+
+								if (!fromIsContainer) {
+									fromActor->unequipItem(item, true, fromMobile, false, itemData);
+								}
+
+								fulfilledCount++;
+								itemsLeftToTransfer--;
+							}
+						}
+
+						currentWeight += itemWeight * fulfilledCount;
+					}
+				}
+
+				if (fulfilledCount > 0) {
+					lastItem = item;
+					totalCount += fulfilledCount;
+					totalValue += fulfilledCount * item->getValue();
+				}
+
+				return fulfilledCount;
+			}
+
+			// Plays sounds and updates equipment and GUI state for everything transferred so far.
+			void finish(sol::table params) {
+				// No items to transfer? Great, let's get out of here.
+				if (totalCount == 0) {
+					return;
+				}
+
+				// Play the relevant sound.
+				auto worldController = TES3::WorldController::get();
+				auto playerMobile = worldController->getMobilePlayer();
+				if (getOptionalParam<bool>(params, "playSound", true)) {
+					if (toMobile == playerMobile) {
+						worldController->playItemUpDownSound(lastItem, true);
+					}
+					else if (fromMobile == playerMobile) {
+						worldController->playItemUpDownSound(lastItem, false);
+					}
+				}
+
+				// Update equipment for creatures/NPCs.
+				if (!fromIsContainer) {
+					fromReference->updateEquipment();
+				}
+				if (toActor->objectType == TES3::ObjectType::NPC || toActor->objectType == TES3::ObjectType::Creature) {
+					toReference->updateEquipment();
+				}
+
+				// If either of them are the player, we need to update the GUI.
+				if (getOptionalParam<bool>(params, "updateGUI", true)) {
+					// Update inventory menu if necessary.
+					if (fromMobile == playerMobile || toMobile == playerMobile) {
+						worldController->inventoryData->clearIcons(2);
+						worldController->inventoryData->addInventoryItems(&playerMobile->npcInstance->inventory, 2);
+						mwse::tes3::ui::inventoryUpdateIcons();
+					}
+
+					// Update contents menu if necessary.
+					auto contentsMenu = TES3::UI::findMenu(*reinterpret_cast<TES3::UI::UI_ID*>(0x7D3098));
+					if (contentsMenu) {
+						// Make sure that the contents reference is one of the ones we care about.
+						TES3::Reference * contentsReference = static_cast<TES3::Reference*>(contentsMenu->getProperty(TES3::UI::PropertyType::Pointer, *reinterpret_cast<TES3::UI::Property*>(0x7D3048)).ptrValue);
+						if (fromReference == contentsReference || toReference == contentsReference) {
+							// If we're looking at a companion, we need to update the profit value and trigger the GUI updates.
+							float isCompanion = *reinterpret_cast<float*>(0x7D3184);
+							if (isCompanion != 0.0f) {
+								float& companionProfit = *reinterpret_cast<float*>(0x7D3188);
+								if (toReference == contentsReference) {
+									companionProfit += totalValue;
+								}
+								else {
+									companionProfit -= totalValue;
+								}
+								TES3::UI::updateContentsCompanionElements();
+							}
+
+							// We also need to update the menu tiles.
+							TES3::UI::updateContentsMenuTiles();
+						}
+					}
+				}
+			}
+
+		private:
+			TES3::Reference * fromReference = nullptr;
+			TES3::Reference * toReference = nullptr;
+			TES3::Actor * fromActor = nullptr;
+			TES3::Actor * toActor = nullptr;
+			TES3::MobileActor * fromMobile = nullptr;
+			TES3::MobileActor * toMobile = nullptr;
+			bool fromIsContainer = false;
+
+			// Container capacity limits. A max capacity of -1 means there is no limit.
+			bool blocked = false;
+			float maxCapacity = -1.0f;
+			float currentWeight = 0.0f;
+
+			// Totals used for the final updates.
+			TES3::Item * lastItem = nullptr;
+			int totalCount = 0;
+			float totalValue = 0.0f;
+		};
+
 		void bindTES3Util() {
 			sol::state& state = LuaManager::getInstance().getState();
 
@@ -503,7 +870,26 @@ namespace mwse {
 			};
 
 			// Bind function: tes3.iterateList
-			state["tes3"]["iterateObjects"] = sol::overload(&iterateObjects, &iterateObjectsFiltered);
+			state["tes3"]["iterateObjects"] = sol::overload(&iterateObjects, &iterateObjectsFiltered, &iterateObjectsFilteredByTable);
+
+			// Bind function: tes3.getObjectCount
+			state["tes3"]["getObjectCount"] = [](sol::object filter) {
+				auto& index = tes3::ObjectTypeIndex::getInstance();
+				size_t count = 0;
+				if (filter.is<double>()) {
+					count = index.getCount(filter.as<unsigned int>());
+				}
+				else if (filter.is<sol::table>()) {
+					sol::table filterTable = filter;
+					for (size_t i = 1, size = filterTable.size(); i <= size; i++) {
+						count += index.getCount(filterTable.get<unsigned int>(i));
+					}
+				}
+				else {
+					throw std::exception("tes3.getObjectCount: Filter must be an object type or an array of object types.");
+				}
+				return count;
+			};
 
 			// Bind function: tes3.getSound
 			state["tes3"]["getSound"] = [](const char* id) -> sol::object {
@@ -517,20 +903,8 @@ namespace mwse {
 			};
 
 			// Bind function: tes3.getSoundGenerator
-			state["tes3"]["getSoundGenerator"] = [](std::string creatureId, unsigned int type) -> sol::object {
-				auto soundGenerators = TES3::DataHandler::get()->nonDynamicData->soundGenerators;
-				const char* creatureIdCstr = creatureId.c_str();
-				for (auto itt = soundGenerators->head; itt != NULL; itt = itt->next) {
-					if (itt->data->soundType != static_cast<TES3::SoundType>(type)) {
-						continue;
-					}
-
-					if (strncmp(creatureIdCstr, itt->data->name, creatureId.length()) == 0) {
-						return makeLuaObject(itt->data);
-					}
-				}
-
-				return sol::nil;
+			state["tes3"]["getSoundGenerator"] = [](const char* creatureId, unsigned int type) -> sol::object {
+				return makeLuaObject(tes3::ObjectIdIndex::getInstance().getSoundGenerator(creatureId, static_cast<TES3::SoundType>(type)));
 			};
 
 			state["tes3"]["getFaction"] = [](const char* id) -> sol::object {
@@ -577,8 +951,7 @@ namespace mwse {
 				return sol::optional<TES3::Vector3>();
 			};
 
-			// Bind function: tes3.getCameraPosition
-			static NI::Pick* rayTestCache = nullptr;
+			// Bind function: tes3.rayTest
 			state["tes3"]["rayTest"] = [](sol::optional<sol::table> params) -> sol::object {
 				// Make sure we got our required position.
 				sol::optional<TES3::Vector3> position = getOptionalParamVector3(params, "position");
@@ -592,85 +965,124 @@ namespace mwse {
 					return false;
 				}
 
-				// Create our pick if it doesn't exist.
-				if (rayTestCache == nullptr) {
-					rayTestCache = NI::Pick::malloc();
-				}
-
-				// Or clean up results otherwise.
-				else {
-					rayTestCache->clearResults();
-				}
+				// Are we finding all or the first?
+				NI::Pick* pick = getRayTestPick(params, getOptionalParam<bool>(params, "findAll", false));
 
-				// TODO: Allow specifying the root?
-				rayTestCache->root = TES3::Game::get()->worldRoot;
+				// Our pick is configured. Let's run it!
+				pick->pickObjects(&position.value(), &direction.value());
 
-				// Are we finding all or the first?
-				if (getOptionalParam<bool>(params, "findAll", false)) {
-					rayTestCache->pickType = NI::PickType::FIND_ALL;
-				}
-				else {
-					rayTestCache->pickType = NI::PickType::FIND_FIRST;
+				// Did we get any results?
+				if (pick->results.filledCount == 0) {
+					return sol::nil;
 				}
 
-				// Sort results by distance?
-				if (getOptionalParam<bool>(params, "sort", true)) {
-					rayTestCache->sortType = NI::PickSortType::SORT;
-				}
-				else {
-					rayTestCache->sortType = NI::PickSortType::NO_SORT;
+				// Are we looking for a single result?
+				else if (pick->pickType == NI::PickType::FIND_FIRST) {
+					return sol::make_object(LuaManager::getInstance().getState(), pick->results.storage[0]);
 				}
 
-				// Use triangle or model bounds for intersection?
-				if (getOptionalParam<bool>(params, "useModelBounds", false)) {
-					rayTestCache->intersectType = NI::PickIntersectType::BOUND_INTERSECT;
-				}
-				else {
-					rayTestCache->intersectType = NI::PickIntersectType::TRIANGLE_INTERSECT;
+				// We're now in multi-result mode. We'll store these in a table.
+				sol::state& state = LuaManager::getInstance().getState();
+				sol::table results = LuaManager::getInstance().createTable();
+				
+				// Go through and clone the results in a way that will play nice.
+				for (int i = 0; i < pick->results.filledCount; i++) {
+					results[i + 1] = pick->results.storage[i];
 				}
 
-				// Use model coordinates or world coordinates?
-				if (getOptionalParam<bool>(params, "useModelCoordinates", false)) {
-					rayTestCache->coordinateType = NI::PickCoordinateType::MODEL_COORDINATES;
-				}
-				else {
-					rayTestCache->coordinateType = NI::PickCoordinateType::WORLD_COORDINATES;
+				return results;
+			};
+
+			// Bind function: tes3.rayTestBatch
+			state["tes3"]["rayTestBatch"] = [](sol::table params) -> sol::table {
+				sol::optional<sol::table> rays = params["rays"];
+				if (!rays) {
+					throw std::exception("tes3.rayTestBatch: No rays provided.");
 				}
 
-				// Use the back side of a triangle? Note: Parameter name flipped!
-				rayTestCache->frontOnly = !getOptionalParam<bool>(params, "useBackTriangles", false);
+				// Results are written into the caller's table when given, so it can be reused between calls.
+				sol::optional<sol::table> maybeResults = params["results"];
+				sol::table results = maybeResults ? maybeResults.value() : LuaManager::getInstance().createTable();
+				sol::table distances = getOrCreateSubtable(results, "distances");
+				sol::table intersections = getOrCreateSubtable(results, "intersections");
+				sol::table references = getOrCreateSubtable(results, "references");
 
-				// Observe app cull flag?
-				rayTestCache->observeAppCullFlag = getOptionalParam<bool>(params, "observeAppCullFlag", true);
+				// The shared options only need to be read once for all rays.
+				float maxDistance = getOptionalParam<float>(params, "maxDistance", 0.0f);
+				NI::Pick* pick = getRayTestPick(params, false, false);
+				bool returnNormal = pick->returnNormal;
+				sol::table normals = returnNormal ? getOrCreateSubtable(results, "normals") : sol::table();
 
-				// Determine what returned values we care about.
-				rayTestCache->returnColor = getOptionalParam<bool>(params, "returnColor", false);
-				rayTestCache->returnNormal = getOptionalParam<bool>(params, "returnNormal", true);
-				rayTestCache->returnSmoothNormal = getOptionalParam<bool>(params, "returnSmoothNormal", false);
-				rayTestCache->returnTexture = getOptionalParam<bool>(params, "returnTexture", false);
+				TES3::Vector3 position;
+				TES3::Vector3 direction;
+				size_t rayCount = rays.value().size();
+				int hitCount = 0;
+				for (size_t i = 1; i <= rayCount; i++) {
+					sol::object ray = rays.value().raw_get<sol::object>(i);
+					if (ray.get_type() != sol::type::table) {
+						throw std::exception("tes3.rayTestBatch: Each ray must be an array of a position and a direction.");
+					}
 
-				// Our pick is configured. Let's run it!
-				rayTestCache->pickObjects(&position.value(), &direction.value());
+					sol::table rayTable = ray;
+					if (!getVectorFromLua(rayTable.raw_get<sol::object>(1), position) || !getVectorFromLua(rayTable.raw_get<sol::object>(2), direction)) {
+						throw std::exception("tes3.rayTestBatch: Each ray must be an array of a position and a direction.");
+					}
 
-				// Did we get any results?
-				if (rayTestCache->results.filledCount == 0) {
-					return sol::nil;
-				}
+					if (i > 1) {
+						pick->clearResults();
+					}
+					pick->pickObjects(&position, &direction);
 
-				// Are we looking for a single result?
-				else if (rayTestCache->pickType == NI::PickType::FIND_FIRST) {
-					return sol::make_object(LuaManager::getInstance().getState(), rayTestCache->results.storage[0]);
+					// Misses are written out as well, so that stale values from a previous call aren't left behind.
+					NI::PickRecord* record = pick->results.filledCount > 0 ? pick->results.storage[0] : nullptr;
+					if (record && maxDistance > 0.0f && record->distance > maxDistance) {
+						record = nullptr;
+					}
+
+					size_t vectorIndex = (i - 1) * 3;
+					if (record) {
+						hitCount++;
+						distances.raw_set(i, record->distance);
+						intersections.raw_set(vectorIndex + 1, record->intersection.x, vectorIndex + 2, record->intersection.y, vectorIndex + 3, record->intersection.z);
+						if (returnNormal) {
+							normals.raw_set(vectorIndex + 1, record->normal.x, vectorIndex + 2, record->normal.y, vectorIndex + 3, record->normal.z);
+						}
+
+						TES3::Reference* reference = NI::getAssociatedReference(record->object);
+						if (reference) {
+							references.raw_set(i, makeLuaObject(reference));
+						}
+						else {
+							references.raw_set(i, false);
+						}
+					}
+					else {
+						distances.raw_set(i, -1.0f);
+						intersections.raw_set(vectorIndex + 1, 0.0f, vectorIndex + 2, 0.0f, vectorIndex + 3, 0.0f);
+						if (returnNormal) {
+							normals.raw_set(vectorIndex + 1, 0.0f, vectorIndex + 2, 0.0f, vectorIndex + 3, 0.0f);
+						}
+						references.raw_set(i, false);
+					}
 				}
 
-				// We're now in multi-result mode. We'll store these in a table.
-				sol::state& state = LuaManager::getInstance().getState();
-				sol::table results = LuaManager::getInstance().createTable();
-				
-				// Go through and clone the results in a way that will play nice.
-				for (int i = 0; i < rayTestCache->results.filledCount; i++) {
-					results[i + 1] = rayTestCache->results.storage[i];
+				// Trim any entries left over from a previous, larger batch.
+				for (size_t i = rayCount + 1, size = distances.size(); i <= size; i++) {
+					distances.raw_set(i, sol::nil);
+					references.raw_set(i, sol::nil);
+				}
+				for (size_t i = rayCount * 3 + 1, size = intersections.size(); i <= size; i++) {
+					intersections.raw_set(i, sol::nil);
 				}
+				if (returnNormal) {
+					for (size_t i = rayCount * 3 + 1, size = normals.size(); i <= size; i++) {
+						normals.raw_set(i, sol::nil);
+					}
+				}
+
+				pick->clearResults();
 
+				results.raw_set("count", rayCount, "hitCount", hitCount);
 				return results;
 			};
 
@@ -1741,6 +2153,32 @@ namespace mwse {
 				return result;
 			};
 
+			state["tes3"]["findReferencesInRadius"] = [](sol::optional<sol::table> params) {
+				sol::optional<TES3::Vector3> position = getOptionalParamVector3(params, "position");
+				if (!position) {
+					throw std::exception("tes3.findReferencesInRadius: No position provided.");
+				}
+
+				float radius = getOptionalParam<float>(params, "radius", 0.0f);
+				if (radius < 0.0f) {
+					throw std::exception("tes3.findReferencesInRadius: Radius must not be negative.");
+				}
+
+				auto types = getOptionalParamObjectTypes(params, "objectType");
+				return makeReferenceArray(tes3::ReferenceSpatialIndex::getInstance().findInRadius(position.value(), radius, types));
+			};
+
+			state["tes3"]["findReferencesInBox"] = [](sol::optional<sol::table> params) {
+				sol::optional<TES3::Vector3> minimum = getOptionalParamVector3(params, "min");
+				sol::optional<TES3::Vector3> maximum = getOptionalParamVector3(params, "max");
+				if (!minimum || !maximum) {
+					throw std::exception("tes3.findReferencesInBox: Both min and max must be provided.");
+				}
+
+				auto types = getOptionalParamObjectTypes(params, "objectType");
+				return makeReferenceArray(tes3::ReferenceSpatialIndex::getInstance().findInBox(minimum.value(), maximum.value(), types));
+			};
+
 			state["tes3"]["positionCell"] = [](sol::table params) {
 				auto worldController = TES3::WorldController::get();
 				auto macp = worldController->getMobilePlayer();
@@ -1958,197 +2396,66 @@ namespace mwse {
 			};
 
 			state["tes3"]["transferItem"] = [](sol::table params) -> int {
-				// Get the reference we are transferring from.
-				TES3::Reference * fromReference = getOptionalParamReference(params, "from");
-				if (fromReference == nullptr) {
-					throw std::invalid_argument("Invalid 'from' parameter provided.");
-				}
-
-				// Get the reference we are transferring to.
-				TES3::Reference * toReference = getOptionalParamReference(params, "to");
-				if (toReference == nullptr) {
-					throw std::invalid_argument("Invalid 'to' parameter provided.");
-				}
-
 				// Get the item we are going to transfer.
 				TES3::Item * item = getOptionalParamObject<TES3::Item>(params, "item");
 				if (item == nullptr) {
 					throw std::invalid_argument("Invalid 'item' parameter provided.");
 				}
 
-				// Make sure we're dealing with actors.
-				TES3::Actor * fromActor = static_cast<TES3::Actor*>(fromReference->baseObject);
-				if (!fromActor->isActor()) {
-					throw std::invalid_argument("The 'from' reference does not point to an actor.");
-				}
-				TES3::Actor * toActor = static_cast<TES3::Actor*>(toReference->baseObject);
-				if (!toActor->isActor()) {
-					throw std::invalid_argument("The 'to' reference does not point to an actor.");
-				}
-
-				// Do either of the references need to be cloned?
-				if (fromReference->clone()) {
-					fromActor = static_cast<TES3::Actor*>(fromReference->baseObject);
-				}
-				if (toReference->clone()) {
-					toActor = static_cast<TES3::Actor*>(toReference->baseObject);
-				}
-
-				// Is the item leveled? Let's resolve it first.
-				while (item->objectType == TES3::ObjectType::LeveledItem) {
-					item = static_cast<TES3::Item*>(reinterpret_cast<TES3::LeveledItem*>(item)->resolve());
-				}
-
 				// Get any associated item data.
 				TES3::ItemData * itemData = getOptionalParam<TES3::ItemData*>(params, "itemData", nullptr);
 
 				// Get how many items we are transferring.
 				int desiredCount = std::max(std::abs(getOptionalParam(params, "count", 1)), 1);
-				int fulfilledCount = 0;
 
-				// Get the mobile objects for the references, if applicable.
-				auto toMobile = toReference->getAttachedMobileActor();
-				auto fromMobile = fromReference->getAttachedMobileActor();
-
-				// Are we looking at a non-container?
-				auto fromIsContainer = (fromActor->objectType == TES3::ObjectType::Container);
-
-				// Manage anything we need to regarding containers.
-				float maxCapacity = -1.0f;
-				float currentWeight = 0.0f;
-				float itemWeight = item->getWeight();
-				if (toActor->objectType == TES3::ObjectType::Container && getOptionalParam<bool>(params, "limitCapacity", true)) {
-					// Prevent placing items into organic containers.
-					if (toActor->getActorFlag(TES3::ActorFlagContainer::Organic)) {
-						return 0;
-					}
-
-					// Figure out the max capacity and currently stored weight of the container.
-					maxCapacity = static_cast<TES3::Container*>(toReference->getBaseObject())->capacity;
-					currentWeight = toActor->inventory.calculateContainedWeight();
-					if (currentWeight > maxCapacity) {
-						return 0;
-					}
-				}
-
-				// Were we given an ItemData? If so, we only need to transfer one item.
-				if (itemData) {
-					if ((maxCapacity == -1.0f || currentWeight + itemWeight <= maxCapacity) && fromActor->inventory.containsItem(item, itemData)) {
-						toActor->inventory.addItem(toMobile, item, 1, false, &itemData);
-						fromActor->inventory.removeItemWithData(fromMobile, item, itemData, 1, false);
-
-						if (!fromIsContainer) {
-							fromActor->unequipItem(item, true, fromMobile, false, itemData);
-						}
-
-						fulfilledCount = 1;
-						currentWeight += itemWeight;
-					}
-				}
-				// No ItemData? We have to go through and transfer items over one by one.
-				else {
-					TES3::ItemStack * fromStack = fromActor->inventory.findItemStack(item);
-					if (fromStack) {
-						int stackCount = std::abs(fromStack->count);
-						int itemsLeftToTransfer = std::min(desiredCount, stackCount);
-
-						// If we're limited by capacity, find out how many items we really want to transfer.
-						if (maxCapacity != -1.0f) {
-							itemsLeftToTransfer = std::min(itemsLeftToTransfer, (int)std::floorf((maxCapacity - currentWeight) / itemWeight));
-						}
-
-						if (itemsLeftToTransfer <= 0) {
-							return 0;
-						}
-
-						// Remove transfer items without data first.
-						int countWithoutVariables = stackCount - (fromStack->variables ? fromStack->variables->endIndex : 0);
-						if (countWithoutVariables > 0) {
-							int amountToTransfer = std::min(countWithoutVariables, itemsLeftToTransfer);
-							toActor->inventory.addItem(toMobile, item, amountToTransfer, false, nullptr);
-							fromActor->inventory.removeItemWithData(fromMobile, item, nullptr, amountToTransfer, false);
-							fulfilledCount += amountToTransfer;
-							itemsLeftToTransfer -= amountToTransfer;
-						}
-
-						// Then transfer over items with data.
-						if (fromStack->variables) {
-							while (itemsLeftToTransfer > 0) {
-								auto itemData = fromStack->variables->storage[0];
-								toActor->inventory.addItem(toMobile, item, 1, false, &fromStack->variables->storage[0]);
-								fromActor->inventory.removeItemWithData(fromMobile, item, itemData, 1, false);
-
-								if (!fromIsContainer) {
-									fromActor->unequipItem(item, true, fromMobile, false, itemData);
-								}
-
-								fulfilledCount++;
-								itemsLeftToTransfer--;
-							}
-						}
-					}
-				}
+				// Only set up the transfer once the parameters are known to be good, as it may clone the references.
+				ItemTransfer transfer(params);
+				int fulfilledCount = transfer.transfer(item, itemData, desiredCount);
+				transfer.finish(params);
+				return fulfilledCount;
+			};
 
-				// No items to transfer? Great, let's get out of here.
-				if (fulfilledCount == 0) {
-					return 0;
+			state["tes3"]["transferItems"] = [](sol::table params) {
+				sol::optional<sol::table> items = params["items"];
+				if (!items) {
+					throw std::invalid_argument("Invalid 'items' parameter provided.");
 				}
 
-				// Play the relevant sound.
-				auto worldController = TES3::WorldController::get();
-				auto playerMobile = worldController->getMobilePlayer();
-				if (getOptionalParam<bool>(params, "playSound", true)) {
-					if (toMobile == playerMobile) {
-						worldController->playItemUpDownSound(item, true);
+				// Validate every entry before anything is moved, so a bad entry can't leave a partial transfer.
+				struct Entry {
+					TES3::Item * item;
+					TES3::ItemData * itemData;
+					int count;
+				};
+				std::vector<Entry> entries;
+				entries.reserve(items.value().size());
+				for (size_t i = 1, size = items.value().size(); i <= size; i++) {
+					sol::optional<sol::table> entry = items.value()[i];
+					TES3::Item * item = getOptionalParamObject<TES3::Item>(entry, "item");
+					if (item == nullptr) {
+						throw std::invalid_argument("Invalid 'item' parameter provided in items array.");
 					}
-					else if (fromMobile == playerMobile) {
-						worldController->playItemUpDownSound(item, false);
-					}
-				}
 
-				// Update equipment for creatures/NPCs.
-				if (!fromIsContainer) {
-					fromReference->updateEquipment();
+					TES3::ItemData * itemData = getOptionalParam<TES3::ItemData*>(entry, "itemData", nullptr);
+					int desiredCount = std::max(std::abs(getOptionalParam(entry, "count", 1)), 1);
+					entries.push_back({ item, itemData, desiredCount });
 				}
-				if (toActor->objectType == TES3::ObjectType::NPC || toActor->objectType == TES3::ObjectType::Creature) {
-					toReference->updateEquipment();
-				}
-
-				// If either of them are the player, we need to update the GUI.
-				if (getOptionalParam<bool>(params, "updateGUI", true)) {
-					// Update inventory menu if necessary.
-					if (fromMobile == playerMobile || toMobile == playerMobile) {
-						worldController->inventoryData->clearIcons(2);
-						worldController->inventoryData->addInventoryItems(&playerMobile->npcInstance->inventory, 2);
-						mwse::tes3::ui::inventoryUpdateIcons();
-					}
 
-					// Update contents menu if necessary.
-					auto contentsMenu = TES3::UI::findMenu(*reinterpret_cast<TES3::UI::UI_ID*>(0x7D3098));
-					if (contentsMenu) {
-						// Make sure that the contents reference is one of the ones we care about.
-						TES3::Reference * contentsReference = static_cast<TES3::Reference*>(contentsMenu->getProperty(TES3::UI::PropertyType::Pointer, *reinterpret_cast<TES3::UI::Property*>(0x7D3048)).ptrValue);
-						if (fromReference == contentsReference || toReference == contentsReference) {
-							// If we're looking at a companion, we need to update the profit value and trigger the GUI updates.
-							float isCompanion = *reinterpret_cast<float*>(0x7D3184);
-							if (isCompanion != 0.0f) {
-								float& companionProfit = *reinterpret_cast<float*>(0x7D3188);
-								if (toReference == contentsReference) {
-									companionProfit += fulfilledCount * item->getValue();
-								}
-								else {
-									companionProfit -= fulfilledCount * item->getValue();
-								}
-								TES3::UI::updateContentsCompanionElements();
-							}
+				// Only set up the transfer once the entries are known to be good, as it may clone the references.
+				ItemTransfer transfer(params);
 
-							// We also need to update the menu tiles.
-							TES3::UI::updateContentsMenuTiles();
-						}
-					}
+				// Move everything before doing any of the expensive updates.
+				sol::state& state = LuaManager::getInstance().getState();
+				sol::table counts = state.create_table(entries.size(), 0);
+				int totalCount = 0;
+				for (size_t i = 0; i < entries.size(); i++) {
+					int fulfilledCount = transfer.transfer(entries[i].item, entries[i].itemData, entries[i].count);
+					counts[i + 1] = fulfilledCount;
+					totalCount += fulfilledCount;
 				}
 
-				return fulfilledCount;
+				transfer.finish(params);
+				return std::make_tuple(totalCount, counts);
 			};
 
 			state["tes3"]["getCurrentAIPackageId"] = [](sol::table params) {
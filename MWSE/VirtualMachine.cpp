@@ -42,7 +42,7 @@
 using namespace mwse;
 
 VirtualMachine::VirtualMachine()
-	: context(),
+	: context(NULL),
 	oldscript(NULL)
 {
 	// Holds the current location in the script. when you read parameters from the script stream, you need to add the number of bytes read to this.
@@ -51,8 +51,11 @@ VirtualMachine::VirtualMachine()
 
 void VirtualMachine::loadParametersForOperation(OpCode::OpCode_t opcode, HookContext &context, TES3::Script* script)
 {
-	InstructionInterface_t * instruction = InstructionStore::getInstance().get(opcode);
+	loadParametersForOperation(*InstructionStore::getInstance().get(opcode), context, script);
+}
 
+void VirtualMachine::loadParametersForOperation(InstructionInterface_t &instruction, HookContext &context, TES3::Script* script)
+{
 	setHookContext(context);
 	setScript(script);
 
@@ -62,24 +65,21 @@ void VirtualMachine::loadParametersForOperation(OpCode::OpCode_t opcode, HookCon
 	}
 	oldscript = script;
 
-	instruction->loadParameters(*this);
-
-	// Feed up any changes to the context to the hook.
-	context = getHookContext();
+	// Any changes to the context are made directly to the hook's context.
+	instruction.loadParameters(*this);
 }
 
 float VirtualMachine::executeOperation(OpCode::OpCode_t opcode, HookContext &context, TES3::Script* script)
 {
-	InstructionInterface_t * instruction = InstructionStore::getInstance().get(opcode);
+	return executeOperation(*InstructionStore::getInstance().get(opcode), context, script);
+}
 
+float VirtualMachine::executeOperation(InstructionInterface_t &instruction, HookContext &context, TES3::Script* script)
+{
 	setHookContext(context);
 	setScript(script);
 
-	float returnvalue = instruction->execute(*this);	//what else does 'execute' need?
-
-	context = getHookContext();
-
-	return returnvalue;
+	return instruction.execute(*this);	//what else does 'execute' need?
 }
 
 void VirtualMachine::OnScriptChange()
@@ -93,14 +93,14 @@ bool VirtualMachine::isOpcode(const OpCode::OpCode_t opcode)
 	return InstructionStore::getInstance().isOpcode(opcode);
 }
 
-void VirtualMachine::setHookContext(HookContext context)
+void VirtualMachine::setHookContext(HookContext& context)
 {
-	this->context = context;
+	this->context = &context;
 }
 
-HookContext VirtualMachine::getHookContext()
+HookContext& VirtualMachine::getHookContext()
 {
-	return this->context;
+	return *this->context;
 }
 
 void VirtualMachine::setScript(TES3::Script* script)
@@ -146,7 +146,7 @@ void VirtualMachine::setReference(TES3::Reference *reference)
 
 	OpCode::OpCode_t opcode = OpCode::_SetReference;	//'->'
 	unsigned char inref = 1;
-	HookContext context = getHookContext();
+	HookContext& context = getHookContext();
 
 	OpCode::OpCode_t * currentOpcode = reinterpret_cast<OpCode::OpCode_t*>(TES3_OP_IMAGE);
 	*currentOpcode = opcode;
@@ -553,7 +553,7 @@ mwseString& VirtualMachine::getString(long fromStack)	//ask grant, need a '*' or
 	// Invalid ID. Return an empty string.
 	if (fromStack == 0x0)
 	{
-		return mwse::string::store::create("");
+		return mwse::string::store::getOrCreate("");
 	}
 
 	// Small enough to fit in the script as a literal string. Parse it from the script
@@ -583,7 +583,7 @@ mwseString& VirtualMachine::getString(long fromStack)	//ask grant, need a '*' or
 	// If it's not in storage, but is probably not a char*, return an empty string and log a message.
 	else if (fromStack < 0x3F0000) {
 		mwse::log::getLog() << "ERROR: Script '" << script->getObjectID() << "' in game file '" << (script->sourceMod != nullptr ? script->sourceMod->filename : "{N/A}") << "' contained garbage string reference! String references cannot be stored across saves." << std::endl;
-		return mwse::string::store::create("");
+		return mwse::string::store::getOrCreate("");
 	}
 
 	// Otherwise, assume it's a char*, though we should never hit this case.
@@ -24,6 +24,7 @@
 #include "VMHookInterface.h"
 #include "VMExecuteInterface.h"
 #include "mwseString.h"
+#include "InstructionInterface.h"
 
 #include "TES3Defines.h"
 
@@ -37,6 +38,10 @@ namespace mwse
 		VirtualMachine();
 		virtual float executeOperation(OpCode::OpCode_t opcode, HookContext &context, TES3::Script* script);
 		virtual void loadParametersForOperation(OpCode::OpCode_t opcode, HookContext &context, TES3::Script* script);
+
+		// Fast paths for the hooks, which have already looked up the instruction.
+		float executeOperation(InstructionInterface_t &instruction, HookContext &context, TES3::Script* script);
+		void loadParametersForOperation(InstructionInterface_t &instruction, HookContext &context, TES3::Script* script);
 		virtual bool isOpcode(const OpCode::OpCode_t opcode);
 		virtual long* getScriptIP();
 
@@ -90,8 +95,6 @@ namespace mwse
 		// Debug method to print information about the current script.
 		virtual void dumpScriptVariables();
 
-		HookContext context;
-
 		TES3::Script* getScript();
 
 	private:
@@ -99,9 +102,11 @@ namespace mwse
 		TES3::Script * script;
 		void setScript(TES3::Script* script);
 		
-		// Current context (registers, etc).
-		HookContext getHookContext();
-		void setHookContext(HookContext context);
+		// Current context (registers, etc). This points to the hook's own context, so that instructions
+		// can change registers without the whole context being copied in and out for every operation.
+		HookContext * context;
+		HookContext& getHookContext();
+		void setHookContext(HookContext& context);
 
 		long *mwScriptIP;
 
@@ -25,6 +25,7 @@
 #include "MemoryUtil.h"
 
 #include "VirtualMachine.h"
+#include "InstructionStore.h"
 
 #include "ScriptUtil.h"
 
@@ -47,11 +48,13 @@ namespace mwse
 		{
 			OpCode::OpCode_t opcode = (OpCode::OpCode_t)context.eax;
 
-			if (vmInstance.isOpcode(opcode))
+			// Look up the instruction only once, instead of checking for it and then fetching it.
+			InstructionInterface_t * instruction = InstructionStore::getInstance().find(opcode);
+			if (instruction)
 			{
 				TES3::Script * script = reinterpret_cast<TES3::Script*>(context.ebx);
 
-				vmInstance.loadParametersForOperation(opcode, context, script);
+				vmInstance.loadParametersForOperation(*instruction, context, script);
 
 				// Set eax to zero. This tells Morrowind that the opcode is invalid and it will return GetNextInstruction.
 				// It doesn't throw any errors when doing so.
@@ -64,14 +67,15 @@ namespace mwse
 		{
 			OpCode::OpCode_t opcode = (OpCode::OpCode_t)context.edx;
 
-			if (vmInstance.isOpcode(opcode))
+			InstructionInterface_t * instruction = InstructionStore::getInstance().find(opcode);
+			if (instruction)
 			{
 				TES3::Script * script = *(reinterpret_cast<TES3::Script**>(context.esp + 0x8));
 
 				// Our default return address. This can be changed below.
 				context.callbackAddress = 0x50D62D;
 
-				float returnValue = vmInstance.executeOperation(opcode, context, script);
+				float returnValue = vmInstance.executeOperation(*instruction, context, script);
 
 				// Increment script instruction pointer in esi, when called from game_executeScript function only.
 				long callReturn = *reinterpret_cast<long*>(context.ebp + 4);
@@ -54,13 +54,7 @@ namespace mwse {
 #if _DEBUG
 			mwse::log::getLog() << "xContentList: Called on invalid reference." << std::endl;
 #endif
-			mwse::Stack::getInstance().pushLong(0);
-			mwse::Stack::getInstance().pushLong(0);
-			mwse::Stack::getInstance().pushFloat(0.0f);
-			mwse::Stack::getInstance().pushLong(0);
-			mwse::Stack::getInstance().pushLong(0);
-			mwse::Stack::getInstance().pushLong(0);
-			mwse::Stack::getInstance().pushLong(0);
+			mwse::Stack::getInstance().pushN(0L, 0L, 0.0f, 0L, 0L, 0L, 0L);
 			return 0.0f;
 		}
 
@@ -93,13 +87,7 @@ namespace mwse {
 		}
 
 		// Push values to the stack.
-		mwse::Stack::getInstance().pushLong((long)next);
-		mwse::Stack::getInstance().pushString(name);
-		mwse::Stack::getInstance().pushFloat(weight);
-		mwse::Stack::getInstance().pushLong(value);
-		mwse::Stack::getInstance().pushLong(type);
-		mwse::Stack::getInstance().pushLong(count);
-		mwse::Stack::getInstance().pushString(id);
+		mwse::Stack::getInstance().pushN((long)next, (const char*)name, weight, value, type, count, (const char*)id);
 
 		return 0.0f;
 	}
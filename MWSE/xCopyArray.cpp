@@ -0,0 +1,71 @@
+/************************************************************************
+	
+	xCopyArray.cpp - Copyright (c) 2008 The MWSE Project
+	https://github.com/MWSE/MWSE/
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+**************************************************************************/
+
+#include "VMExecuteInterface.h"
+#include "Stack.h"
+#include "InstructionInterface.h"
+#include "ArrayUtil.h"
+
+using namespace mwse;
+
+namespace mwse
+{
+	class xCopyArray : mwse::InstructionInterface_t
+	{
+	public:
+		xCopyArray();
+		virtual float execute(VMExecuteInterface &virtualMachine);
+		virtual void loadParameters(VMExecuteInterface &virtualMachine);
+	};
+
+	static xCopyArray xCopyArrayInstance;
+
+	xCopyArray::xCopyArray() : mwse::InstructionInterface_t(OpCode::xCopyArray) {}
+
+	void xCopyArray::loadParameters(mwse::VMExecuteInterface &virtualMachine) {}
+
+	float xCopyArray::execute(mwse::VMExecuteInterface &virtualMachine)
+	{
+		if (mwse::Stack::getInstance().size() < 5) {
+			mwse::log::getLog() << "xCopyArray: Function called with too few arguments." << std::endl;
+			mwse::Stack::getInstance().pushLong(0);
+			return 0.0f;
+		}
+
+		long sourceId = mwse::Stack::getInstance().popLong();
+		long sourceIndex = mwse::Stack::getInstance().popLong();
+		long destinationId = mwse::Stack::getInstance().popLong();
+		long destinationIndex = mwse::Stack::getInstance().popLong();
+		long count = mwse::Stack::getInstance().popLong();
+
+		long copied = 0;
+		if (sourceIndex < 0 || destinationIndex < 0 || count < 0) {
+			mwse::log::getLog() << "xCopyArray: Array index out of bounds. source index: " << sourceIndex << " destination index: " << destinationIndex << " count: " << count << std::endl;
+		}
+		else {
+			copied = mwse::Arrays::getInstance().copy("xCopyArray", sourceId, sourceIndex, destinationId, destinationIndex, count);
+		}
+
+		mwse::Stack::getInstance().pushLong(copied);
+
+		return 0.0f;
+	}
+}
\ No newline at end of file
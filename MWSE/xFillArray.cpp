@@ -0,0 +1,70 @@
+/************************************************************************
+	
+	xFillArray.cpp - Copyright (c) 2008 The MWSE Project
+	https://github.com/MWSE/MWSE/
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+**************************************************************************/
+
+#include "VMExecuteInterface.h"
+#include "Stack.h"
+#include "InstructionInterface.h"
+#include "ArrayUtil.h"
+
+using namespace mwse;
+
+namespace mwse
+{
+	class xFillArray : mwse::InstructionInterface_t
+	{
+	public:
+		xFillArray();
+		virtual float execute(VMExecuteInterface &virtualMachine);
+		virtual void loadParameters(VMExecuteInterface &virtualMachine);
+	};
+
+	static xFillArray xFillArrayInstance;
+
+	xFillArray::xFillArray() : mwse::InstructionInterface_t(OpCode::xFillArray) {}
+
+	void xFillArray::loadParameters(mwse::VMExecuteInterface &virtualMachine) {}
+
+	float xFillArray::execute(mwse::VMExecuteInterface &virtualMachine)
+	{
+		if (mwse::Stack::getInstance().size() < 4) {
+			mwse::log::getLog() << "xFillArray: Function called with too few arguments." << std::endl;
+			mwse::Stack::getInstance().pushShort(0);
+			return 0.0f;
+		}
+
+		long id = mwse::Stack::getInstance().popLong();
+		long start = mwse::Stack::getInstance().popLong();
+		long count = mwse::Stack::getInstance().popLong();
+		long value = mwse::Stack::getInstance().popLong();
+
+		long status = 0;
+		if (start < 0 || count < 0) {
+			mwse::log::getLog() << "xFillArray: Array index out of bounds. id: " << id << " index: " << start << " count: " << count << std::endl;
+		}
+		else {
+			status = mwse::Arrays::getInstance().fill("xFillArray", id, start, count, value);
+		}
+
+		mwse::Stack::getInstance().pushShort(status);
+
+		return 0.0f;
+	}
+}
\ No newline at end of file
@@ -87,12 +87,7 @@ namespace mwse
 #endif
 		}
 
-		mwse::Stack::getInstance().pushLong(magMax);
-		mwse::Stack::getInstance().pushLong(magMin);
-		mwse::Stack::getInstance().pushLong(duration);
-		mwse::Stack::getInstance().pushLong(area);
-		mwse::Stack::getInstance().pushLong(rangeType);
-		mwse::Stack::getInstance().pushLong(effectEnumId);
+		mwse::Stack::getInstance().pushN(magMax, magMin, duration, area, rangeType, effectEnumId);
 
 		return 0.0f;
 	}
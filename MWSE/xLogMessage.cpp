@@ -63,7 +63,7 @@ namespace mwse
 
 		bool suppressNull = false;
 		std::string badCodes;
-		std::string& result = mwse::string::interpolate(format, virtualMachine, &suppressNull, &badCodes);
+		const std::string& result = mwse::string::interpolate(format, virtualMachine, &suppressNull, &badCodes);
 
 		mwse::log::getLog() << result << std::endl;
 		if (!badCodes.empty()) {
@@ -0,0 +1,4 @@
+return {
+	type = "lib",
+	description = "The mwse array library provides access to mwscript array storage. Index parameters are zero-based, matching mwscript.",
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+return {
+	type = "function",
+	description = [[Copies a range of values from one array to another, returning the number of values copied.]],
+	arguments = {
+		{ name = "source", type = "number" },
+		{ name = "sourceIndex", type = "number" },
+		{ name = "destination", type = "number" },
+		{ name = "destinationIndex", type = "number" },
+		{ name = "count", type = "number" },
+	},
+	returns = "number",
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+return {
+	type = "function",
+	description = [[Creates a new mwscript array, and returns its id.]],
+	returns = "number",
+}
\ No newline at end of file
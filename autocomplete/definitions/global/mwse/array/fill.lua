@@ -0,0 +1,11 @@
+return {
+	type = "function",
+	description = [[Sets a range of values in an array. By default, every value from start to the end of the array is set.]],
+	arguments = {
+		{ name = "array", type = "number", description = "An array id, or an array view." },
+		{ name = "value", type = "number" },
+		{ name = "start", type = "number", optional = true },
+		{ name = "count", type = "number", optional = true },
+	},
+	returns = "boolean",
+}
\ No newline at end of file
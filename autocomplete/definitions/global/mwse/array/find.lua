@@ -0,0 +1,9 @@
+return {
+	type = "function",
+	description = [[Performs a binary search on a sorted array, returning the index of the value or nil if it was not found.]],
+	arguments = {
+		{ name = "array", type = "number", description = "An array id, or an array view." },
+		{ name = "value", type = "number" },
+	},
+	returns = "number",
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+return {
+	type = "function",
+	description = [[Returns the number of values in an array.]],
+	arguments = {
+		{ name = "array", type = "number", description = "An array id, or an array view." },
+	},
+	returns = "number",
+}
\ No newline at end of file
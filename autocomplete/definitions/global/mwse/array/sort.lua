@@ -0,0 +1,8 @@
+return {
+	type = "function",
+	description = [[Sorts an array in ascending order.]],
+	arguments = {
+		{ name = "array", type = "number", description = "An array id, or an array view." },
+	},
+	returns = "boolean",
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+return {
+	type = "function",
+	description = [[Returns a view of the array with the given id, or nil if the array does not exist. The view reads and writes the array storage directly. Unlike the rest of this library, views use lua-style indices starting at 1, so view[1] is mwscript index 0.]],
+	arguments = {
+		{ name = "id", type = "number" },
+	},
+	returns = "mwseArrayView",
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+return {
+	type = "function",
+	description = [[Returns true if event payloads are lazily materialized. See mwse.setLazyEventPayloads.]],
+	returns = "boolean",
+}
\ No newline at end of file
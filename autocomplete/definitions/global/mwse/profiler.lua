@@ -0,0 +1,4 @@
+return {
+	type = "lib",
+	description = "The mwse profiler library measures time spent dispatching events, and in each event callback.",
+}
\ No newline at end of file
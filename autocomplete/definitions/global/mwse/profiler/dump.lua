@@ -0,0 +1,4 @@
+return {
+	type = "function",
+	description = [[Writes the collected statistics to MWSE.log, with events sorted by total time spent.]],
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+return {
+	type = "function",
+	description = [[Returns how often, in seconds, statistics are automatically written to MWSE.log. A value of 0 means statistics are never automatically written.]],
+	returns = "number",
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+return {
+	type = "function",
+	description = [[Returns true if the event profiler is collecting statistics.]],
+	returns = "boolean",
+}
\ No newline at end of file
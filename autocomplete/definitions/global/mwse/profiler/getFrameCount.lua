@@ -0,0 +1,5 @@
+return {
+	type = "function",
+	description = [[Returns the number of frames that have passed since statistics were last reset.]],
+	returns = "number",
+}
\ No newline at end of file
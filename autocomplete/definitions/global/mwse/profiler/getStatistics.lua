@@ -0,0 +1,8 @@
+return {
+	type = "function",
+	description = [[Returns collected statistics, keyed by event type. Each entry contains count, total, mean, p99, max, and perFrame fields, with times in milliseconds. The callbacks field is an array of the same statistics for each callback, with the source file and line the callback was defined at.]],
+	arguments = {
+		{ name = "eventType", type = "string", optional = true },
+	},
+	returns = "table",
+}
\ No newline at end of file
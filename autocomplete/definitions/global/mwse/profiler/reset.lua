@@ -0,0 +1,4 @@
+return {
+	type = "function",
+	description = [[Clears all collected statistics, and restarts the frame count.]],
+}
\ No newline at end of file
@@ -0,0 +1,7 @@
+return {
+	type = "function",
+	description = [[Sets how often, in seconds, statistics are automatically written to MWSE.log while the profiler is enabled. A value of 0 disables automatic dumps.]],
+	arguments = {
+		{ name = "seconds", type = "number" },
+	},
+}
\ No newline at end of file
@@ -0,0 +1,7 @@
+return {
+	type = "function",
+	description = [[Enables or disables the event profiler. While disabled, events are not timed.]],
+	arguments = {
+		{ name = "enabled", type = "boolean" },
+	},
+}
\ No newline at end of file
@@ -0,0 +1,7 @@
+return {
+	type = "function",
+	description = [[When enabled, supporting events (such as damage, calcBarterPrice, spellTick, and the movement speed events) only convert object fields like mobile or reference into lua objects when a handler first reads them. Lazily resolved fields are not visible to pairs until read, and fields not read while the event is being dispatched are nil afterwards.]],
+	arguments = {
+		{ name = "enabled", type = "boolean" },
+	},
+}
\ No newline at end of file
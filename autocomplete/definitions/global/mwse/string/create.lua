@@ -2,7 +2,7 @@ return {
 	type = "function",
 	description = [[Creates a string in storage, and returns the numerical key for it.
 
-If the string is already in storage, the previous key will be returned.]],
+If the string is already in storage, the previous key will be returned. The string is retained, as with mwse.string.retain, so the key stays valid across game loads. Call mwse.string.release once the string is no longer needed to allow it to be freed.]],
 	arguments = {
 		{ type = "string" }
 	},
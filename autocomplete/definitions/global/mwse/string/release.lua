@@ -0,0 +1,8 @@
+return {
+	type = "function",
+	description = [[Releases a string previously kept with mwse.string.retain or created with mwse.string.create, allowing it to be freed from storage.]],
+	arguments = {
+		{ type = "number" }
+	},
+	returns = "boolean",
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+return {
+	type = "function",
+	description = [[Prevents a string from being freed from storage. Strings created by mwscript are freed when a game is loaded, once they are at least one load old. Strings created with mwse.string.create are already retained. Each call must be matched by a call to mwse.string.release.]],
+	arguments = {
+		{ type = "number" }
+	},
+	returns = "boolean",
+}
\ No newline at end of file
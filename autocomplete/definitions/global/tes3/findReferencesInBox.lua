@@ -0,0 +1,15 @@
+return {
+	type = "function",
+	description = [[Finds all references in the active cells whose position is inside a given axis-aligned box. Results are unordered.]],
+	arguments = {{
+		name = "params",
+		type = "table",
+		tableParams = {
+			{ name = "min", type = "tes3vector3|table", description = "The minimum corner of the box." },
+			{ name = "max", type = "tes3vector3|table", description = "The maximum corner of the box." },
+			{ name = "objectType", type = "number|table", optional = true, description = "If provided, only references whose base object is of this type, or one of these types, are returned." },
+		},
+	}},
+	returns = "references",
+	valuetype = "table",
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+return {
+	type = "function",
+	description = [[Finds all references in the active cells whose position is within a given distance of a point. Results are unordered.]],
+	arguments = {{
+		name = "params",
+		type = "table",
+		tableParams = {
+			{ name = "position", type = "tes3vector3|table", description = "The center of the search sphere." },
+			{ name = "radius", type = "number", description = "The maximum distance from the position." },
+			{ name = "objectType", type = "number|table", optional = true, description = "If provided, only references whose base object is of this type, or one of these types, are returned." },
+		},
+	}},
+	returns = "references",
+	valuetype = "table",
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+return {
+	type = "function",
+	description = [[Returns the number of game objects of a given type, or the total for several types, without creating any objects for lua.]],
+	arguments = {
+		{ name = "filter", type = "number|table", description = "Maps to tes3.objectType constants. May also be an array of object types." }
+	},
+	returns = "count",
+	valuetype = "number",
+}
\ No newline at end of file
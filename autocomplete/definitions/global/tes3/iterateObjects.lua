@@ -1,8 +1,8 @@
 return {
 	type = "function",
-	description = [[Iteration function used for looping over game options.]],
+	description = [[Iteration function used for looping over game objects. If a filter is given, only objects of those types are visited, without touching any other objects. When given several types, all objects of the first type are visited before any of the next.]],
 	arguments = {
-		{ name = "filter", type = "number", description = "Maps to tes3.objectType constants." }
+		{ name = "filter", type = "number|table", optional = true, description = "Maps to tes3.objectType constants. May also be an array of object types." }
 	},
 	returns = "object",
 	valuetype = "tes3object",
@@ -0,0 +1,21 @@
+return {
+	type = "function",
+	description = [[Performs many ray tests at once, sharing a single set of options. Each ray only reports its closest result. Results are written into flat arrays in the results table, which can be passed back in on later calls to avoid creating new tables. For ray i, distances[i] is the hit distance or -1 for a miss, intersections[i*3-2] through intersections[i*3] hold the hit position, and references[i] is the hit reference or false. The count and hitCount fields hold the number of rays and hits.]],
+	arguments = {{
+		name = "params",
+		type = "table",
+		tableParams = {
+			{ name = "rays", type = "table", description = "An array of rays. Each ray is an array of a position and a direction, given as tes3vector3s or tables." },
+			{ name = "results", type = "table", optional = true, description = "A table to write results into. If not provided, a new table is created." },
+			{ name = "maxDistance", type = "number", default = 0, description = "If greater than zero, hits beyond this distance are treated as misses." },
+			{ name = "sort", type = "boolean", default = true, description = "If true, the results will be sorted by distance from the origin position." },
+			{ name = "useModelBounds", type = "boolean", default = false, description = "If true, model bounds will be tested for intersection. Otherwise triangles will be used." },
+			{ name = "useModelCoordinates", type = "boolean", default = false, description = "If true, model coordinates will be used instead of world coordinates." },
+			{ name = "useBackTriangles", type = "boolean", default = false },
+			{ name = "observeAppCullFlag", type = "boolean", default = true },
+			{ name = "returnNormal", type = "boolean", default = false, description = "If true, hit normals are written into a flat normals array, laid out like intersections." },
+		},
+	}},
+	returns = "results",
+	valuetype = "table",
+}
\ No newline at end of file
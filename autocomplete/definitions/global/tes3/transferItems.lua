@@ -0,0 +1,17 @@
+return {
+	type = "function",
+	description = [[Moves many items from one reference to another in a single call. Works like tes3.transferItem for each entry, but sounds, equipment updates and GUI refreshes only happen once, after all items have been moved. Returns the total amount of items transferred, and an array with the amount transferred for each entry.]],
+	arguments = {{
+		name = "params",
+		type = "table",
+		tableParams = {
+			{ name = "from", type = "tes3reference|tes3mobileActor|string", description = "Who to take items from." },
+			{ name = "to", type = "tes3reference|tes3mobileActor|string", description = "Who to give items to." },
+			{ name = "items", type = "table", description = "An array of tables, each with an item, and optionally itemData and count fields. These work the same as the parameters to tes3.transferItem." },
+			{ name = "playSound", type = "boolean", default = true, description = "If false, the up/down sound won't be played. Only one sound is played for the whole batch." },
+			{ name = "limitCapacity", type = "boolean", default = true, description = "If false, items can be placed into containers that shouldn't normally be allowed. This includes organic containers, and containers that are full." },
+			{ name = "updateGUI", type = "boolean", default = true, description = "If false, the function won't manually resync the player's GUI state. `tes3ui.forcePlayerInventoryUpdate()` must then be called manually." },
+		},
+	}},
+	returns = {{ name = "transferredCount", type = "number" }, { name = "counts", type = "table" }},
+}
\ No newline at end of file
@@ -0,0 +1,7 @@
+return {
+	type = "function",
+	description = [[Runs a function, deferring any element:updateLayout() calls it makes until it finishes. Each affected region is then laid out once. Regions stop at the nearest element whose size is fixed, so an update inside a fixed-size block doesn't lay out the rest of its menu.]],
+	arguments = {
+		{ name = "callback", type = "function" },
+	},
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+return {
+	type = "function",
+	description = [[Returns a handle for a property name, for use with the element getProperty and setProperty functions. The name is only looked up the first time it is used, so code that touches many elements can resolve its property names ahead of time instead of on every access.
+
+The handle is the same value that tes3ui.registerProperty returns for the name.]],
+	arguments = {
+		{ name = "name", type = "string" },
+	},
+	returns = "number",
+}
\ No newline at end of file
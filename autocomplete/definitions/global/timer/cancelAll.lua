@@ -0,0 +1,9 @@
+return {
+	type = "function",
+	description = [[Cancels every timer that was started with the given owner. Returns the number of timers cancelled.]],
+	arguments = {
+		{ name = "owner", type = "any" },
+		{ name = "type", type = "number", optional = true, description = "If provided, only timers of this type are cancelled." },
+	},
+	returns = "number",
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+return {
+	type = "function",
+	description = [[Creates many timers at once. This is faster than calling timer.start for each timer when scheduling a large number of timers.]],
+	arguments = {{
+		name = "params",
+		type = "table",
+		tableParams = {
+			{ name = "type", type = "number", optional = true },
+			{ name = "owner", type = "any", optional = true, description = "An owner applied to every timer in the batch that doesn't provide its own. Timers can be cancelled by owner with timer.cancelAll." },
+			{ name = "timers", type = "table", description = "An array of tables, each with the duration, callback, and optional iterations and owner parameters accepted by timer.start." },
+		}
+	}},
+	returns = "table",
+}
\ No newline at end of file
@@ -258,7 +258,6 @@ lfs.rmdir = deleteDirectoryRecursive
 -------------------------------------------------
 
 _G.tes3 = require("tes3.init")
-_G.event = require("event")
 _G.json = require("dkjson")
 
 -------------------------------------------------